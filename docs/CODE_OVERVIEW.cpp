@@ -327,12 +327,12 @@
  * 
  * Step 2: Run Simple Example
  * ──────────────────────────
- * g++ -std=c++17 simple_example.cpp -o simple.exe
+ * g++ -std=c++17 -pthread simple_example.cpp -o simple.exe
  * .\simple.exe
  * 
  * Step 3: Run Full Example
  * ────────────────────────
- * g++ -std=c++17 main.cpp -o zksnark.exe
+ * g++ -std=c++17 -pthread main.cpp -o zksnark.exe
  * .\zksnark.exe
  * 
  * Step 4: Study Source Code
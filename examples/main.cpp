@@ -135,26 +135,23 @@ int main() {
         
         std::cout << "\nQAP Created with " << qap.num_variables << " polynomials" << std::endl;
         
-        // Verify QAP by evaluating at constraint points
+        // Check the witness against the QAP: O(N + nnz)
         std::cout << "\n=== Verifying QAP Conversion ===" << std::endl;
-        Polynomial A_poly, B_poly, C_poly;
-        qap.computePolynomials(witness, A_poly, B_poly, C_poly);
-        
-        for (int i = 0; i < num_constraints; i++) {
-            FieldElement eval_point(i + 1);
-            FieldElement a_val = A_poly.evaluate(eval_point);
-            FieldElement b_val = B_poly.evaluate(eval_point);
-            FieldElement c_val = C_poly.evaluate(eval_point);
-            FieldElement z_val = qap.Z.evaluate(eval_point);
-            
-            std::cout << "At x=" << eval_point << ": ";
-            std::cout << "A=" << a_val << ", B=" << b_val << ", C=" << c_val;
-            std::cout << ", Z=" << z_val << std::endl;
-            
-            // At constraint points, Z should be 0
-            if (z_val != FieldElement(0)) {
-                std::cout << "  Warning: Z should be 0 at constraint points" << std::endl;
-            }
+        FieldElement r = qap.randomPoint();
+        FieldElement at_r[3];
+        qap.evaluateWitnessAt(witness, r, at_r);
+        std::cout << "At random r=" << r << ": ";
+        std::cout << "A=" << at_r[0] << ", B=" << at_r[1] << ", C=" << at_r[2];
+        std::cout << ", Z=" << qap.domain.evaluateVanishing(r) << std::endl;
+        
+        size_t unsatisfied = 0;
+        bool qap_valid = qap.checkWitness(witness, &unsatisfied);
+        std::cout << "Every constraint residual a_i·b_i - c_i is zero: "
+                  << (qap_valid ? "✓ PASSED" : "✗ FAILED") << std::endl;
+        if (!qap_valid) {
+            std::cout << "Constraint " << unsatisfied << " is not satisfied" << std::endl;
+            std::cout << "QAP check failed! Exiting." << std::endl;
+            return 1;
         }
         
         // Step 3: Setup - Generate keys
@@ -164,9 +161,9 @@ int main() {
         
         ProvingKey pk;
         VerificationKey vk;
-        int num_public_inputs = 1; // Just the output
+        std::vector<size_t> public_variables = {2}; // Just the output (variable 2)
         
-        zkSNARK::setup(qap, r1cs, pk, vk, num_public_inputs);
+        zkSNARK::setup(qap, r1cs, pk, vk, public_variables);
         
         std::cout << "\nProving key size: " << pk.A_query.size() << " elements" << std::endl;
         std::cout << "Verification key IC size: " << vk.IC.size() << " elements" << std::endl;
@@ -197,6 +194,27 @@ int main() {
         
         bool proof_valid = zkSNARK::verify(vk, proof, public_inputs);
         
+        // A verifier that checks many proofs prepares the key once
+        PreparedVerificationKey prepared_vk(vk);
+        bool prepared_valid = prepared_vk.verify(proof, public_inputs);
+        std::cout << "Prepared verification key agrees: "
+                  << (prepared_valid == proof_valid ? "yes" : "no") << std::endl;
+        
+        // Soundness: the pairing check must reject a tampered proof and a
+        // wrong public output
+        std::cout << "\n=== Checking that bad proofs are rejected ===" << std::endl;
+        Proof tampered = proof;
+        tampered.C = tampered.C + ToyPairing::g1();
+        bool tampered_rejected = !zkSNARK::verify(vk, tampered, public_inputs);
+        std::vector<FieldElement> wrong_inputs = {out + FieldElement(1)};
+        bool wrong_input_rejected = !zkSNARK::verify(vk, proof, wrong_inputs);
+        std::cout << "Tampered proof rejected: " << (tampered_rejected ? "yes" : "no") << std::endl;
+        std::cout << "Wrong public output rejected: " << (wrong_input_rejected ? "yes" : "no") << std::endl;
+        if (!tampered_rejected || !wrong_input_rejected) {
+            std::cout << "Verifier accepted a bad proof! Exiting." << std::endl;
+            return 1;
+        }
+        
         std::cout << "\n" << std::string(50, '=') << std::endl;
         std::cout << "FINAL RESULT" << std::endl;
         std::cout << std::string(50, '=') << std::endl;
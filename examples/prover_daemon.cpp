@@ -0,0 +1,130 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <csignal>
+#include "../src/field.h"
+#include "../src/r1cs.h"
+#include "../src/qap.h"
+#include "../src/zksnark.h"
+#include "../src/prover_server.h"
+
+// Prover daemon for the x^3 + x + 5 = out circuit of main.cpp.
+//
+// The circuit, its QAP and its keys are built once at startup; proof jobs
+// then arrive over a Unix domain socket (see prover_server.h) and pay only
+// for proving. Circuit 1 accepts either the full witness [1, x, out, x^2,
+// x^3] or just the input x.
+//
+//   prover_daemon [socket_path]           serve until SIGINT / SIGTERM
+//   prover_daemon [socket_path] --demo    serve, send a few jobs, drain
+//
+// SIGINT and SIGTERM drain the server: queued jobs are still proved and
+// answered before it exits.
+
+static ProverServer* active_server = nullptr;
+
+extern "C" void handleStopSignal(int) {
+    if (active_server != nullptr) active_server->requestDrain();
+}
+
+static R1CS cubicR1CS() {
+    R1CS r1cs(5, 3);
+    FieldElement zero(0), one(1);
+    // x * x = v1
+    r1cs.setConstraint(0, {zero, one, zero, zero, zero}, {zero, one, zero, zero, zero},
+                          {zero, zero, zero, one, zero});
+    // v1 * x = v2
+    r1cs.setConstraint(1, {zero, zero, zero, one, zero}, {zero, one, zero, zero, zero},
+                          {zero, zero, zero, zero, one});
+    // (v2 + x + 5) * 1 = out
+    r1cs.setConstraint(2, {FieldElement(5), one, zero, zero, one}, {one, zero, zero, zero, zero},
+                          {zero, zero, one, zero, zero});
+    return r1cs;
+}
+
+// Witness [1, x, out, v1, v2] from the input x
+static std::vector<FieldElement> cubicWitness(const std::vector<FieldElement>& inputs) {
+    if (inputs.size() != 1) {
+        throw std::runtime_error("The cubic circuit takes one input");
+    }
+    FieldElement x = inputs[0];
+    FieldElement v1 = x * x;
+    FieldElement v2 = v1 * x;
+    return {FieldElement(1), x, v2 + x + FieldElement(5), v1, v2};
+}
+
+static const char* statusName(JobStatus status) {
+    switch (status) {
+        case JobStatus::Ok: return "ok";
+        case JobStatus::Busy: return "busy";
+        case JobStatus::UnknownCircuit: return "unknown circuit";
+        case JobStatus::InvalidWitness: return "invalid witness";
+        case JobStatus::BadRequest: return "bad request";
+        case JobStatus::ShuttingDown: return "shutting down";
+        case JobStatus::InternalError: return "internal error";
+    }
+    return "?";
+}
+
+int main(int argc, char** argv) {
+    std::string socket_path = "/tmp/zksnark-prover.sock";
+    bool demo = false;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--demo") {
+            demo = true;
+        } else {
+            socket_path = arg;
+        }
+    }
+
+    try {
+        // One-time cost: circuit, QAP, keys
+        R1CS r1cs = cubicR1CS();
+        QAP qap = QAP::fromR1CS(r1cs);
+        ProvingKey pk;
+        VerificationKey vk;
+        zkSNARK::setup(qap, r1cs, pk, vk, std::vector<size_t>{2});
+        PreparedVerificationKey prepared_vk(vk);
+
+        zkSNARK::setVerbose(false);
+        ProverServer server(socket_path);
+        server.addCircuit(1, qap, pk, cubicWitness, 1);
+        server.start();
+        active_server = &server;
+        std::signal(SIGINT, handleStopSignal);
+        std::signal(SIGTERM, handleStopSignal);
+        std::cout << "\nProver daemon listening on " << socket_path << std::endl;
+
+        if (demo) {
+            ProverClient client(socket_path);
+            for (uint64_t job = 1; job <= 4; job++) {
+                ProofRequest request;
+                request.job_id = job;
+                request.circuit_id = 1;
+                request.kind = JobKind::Inputs;
+                request.values = {FieldElement(job + 2)};
+                ProofResponse response = client.prove(request);
+                FieldElement out = cubicWitness(request.values)[2];
+                bool valid = response.status == JobStatus::Ok &&
+                             prepared_vk.verify(response.proof, std::vector<FieldElement>{out});
+                std::cout << "  job " << response.job_id << ": " << statusName(response.status)
+                          << ", queued " << response.queue_us << " us, proved in "
+                          << response.prove_us << " us, total " << response.total_us << " us"
+                          << (valid ? ", verified" : "") << std::endl;
+            }
+            server.requestDrain();
+        }
+
+        server.wait();
+        active_server = nullptr;
+        ProverServer::Stats stats = server.stats();
+        std::cout << "Drained: " << stats.completed << " proofs, " << stats.failed << " failed, "
+                  << stats.rejected << " rejected as busy, over " << stats.connections
+                  << " connection(s)" << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "\nError: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
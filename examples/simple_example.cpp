@@ -115,12 +115,12 @@ int main() {
         
         ProvingKey pk;
         VerificationKey vk;
-        int num_public_inputs = 1; // Just the output
+        std::vector<size_t> public_variables = {2}; // Just the output (variable 2)
         
         std::cout << "\nGenerating proving and verification keys..." << std::endl;
         std::cout << "(In real systems, this uses secure MPC ceremony)" << std::endl;
         
-        zkSNARK::setup(qap, r1cs, pk, vk, num_public_inputs);
+        zkSNARK::setup(qap, r1cs, pk, vk, public_variables);
         
         std::cout << "\n✓ Keys generated successfully" << std::endl;
         std::cout << "  Proving key: " << pk.A_query.size() << " EC points" << std::endl;
@@ -157,7 +157,7 @@ int main() {
         std::cout << "\nVerifier's knowledge:" << std::endl;
         std::cout << "  ✓ Public output: " << out << std::endl;
         std::cout << "  ✗ Secret input: UNKNOWN (this is the point!)" << std::endl;
-        std::cout << "  ✓ Proof from prover: 3 EC points" << std::endl;
+        std::cout << "  ✓ Proof from prover: 3 group elements" << std::endl;
         std::cout << "  ✓ Verification key" << std::endl;
         
         std::cout << "\nVerifying proof..." << std::endl;
@@ -0,0 +1,153 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <memory_resource>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <iostream>
+
+// Monotonic arena for short-lived buffers (interpolation scratch, NTT
+// temporaries, batch-inversion prefixes, ...).
+//
+// Allocation bumps a pointer inside the current chunk; deallocation is a
+// no-op. Memory is given back by rewinding to a mark (see ArenaScope), and
+// chunks are kept across rewinds, so once an arena has grown to the size a
+// pipeline phase needs, that phase performs no further heap allocations.
+//
+// Arena is a std::pmr::memory_resource, so any std::pmr container can draw
+// from it:  std::pmr::vector<FieldElement> tmp(n, &scratchArena());
+class Arena : public std::pmr::memory_resource {
+public:
+    // Position in the arena; rewinding to it frees everything allocated after
+    struct Mark {
+        size_t chunk;
+        size_t offset;
+        size_t in_use;
+    };
+
+private:
+    struct Chunk {
+        char* data;
+        size_t size;
+    };
+
+    std::vector<Chunk> chunks;
+    size_t current;      // index of the chunk being bumped
+    size_t offset;       // bump offset inside chunks[current]
+    size_t in_use;       // bytes handed out since the arena was empty
+    size_t high_water;   // largest in_use ever seen
+    size_t capacity;     // total bytes held in chunks
+    size_t upstream_allocations;
+    size_t initial_chunk_size;
+
+    void addChunk(size_t min_size, size_t position) {
+        size_t size = std::max(min_size, chunks.empty() ? initial_chunk_size : chunks.back().size * 2);
+        Chunk chunk;
+        chunk.data = static_cast<char*>(std::pmr::new_delete_resource()->allocate(size, alignof(std::max_align_t)));
+        chunk.size = size;
+        chunks.insert(chunks.begin() + position, chunk);
+        capacity += size;
+        upstream_allocations++;
+    }
+
+protected:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        if (bytes == 0) bytes = 1;
+
+        while (true) {
+            if (current < chunks.size()) {
+                Chunk& chunk = chunks[current];
+                uintptr_t base = reinterpret_cast<uintptr_t>(chunk.data);
+                uintptr_t aligned = (base + offset + alignment - 1) & ~(uintptr_t(alignment) - 1);
+                size_t start = aligned - base;
+                if (start + bytes <= chunk.size) {
+                    in_use += (start - offset) + bytes;
+                    high_water = std::max(high_water, in_use);
+                    offset = start + bytes;
+                    return chunk.data + start;
+                }
+
+                // Does not fit: the rest of this chunk is wasted until rewind
+                in_use += chunk.size - offset;
+            }
+
+            // Move on to the next retained chunk if it is large enough,
+            // otherwise insert a fresh one right after the current position
+            size_t next = (current < chunks.size()) ? current + 1 : chunks.size();
+            if (next >= chunks.size() || chunks[next].size < bytes + alignment) {
+                addChunk(bytes + alignment, next);
+            }
+            current = next;
+            offset = 0;
+        }
+    }
+
+    void do_deallocate(void*, size_t, size_t) override {}
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+public:
+    explicit Arena(size_t first_chunk_size = 64 * 1024)
+        : current(0), offset(0), in_use(0), high_water(0), capacity(0),
+          upstream_allocations(0), initial_chunk_size(first_chunk_size) {}
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    ~Arena() override {
+        for (auto& chunk : chunks) {
+            std::pmr::new_delete_resource()->deallocate(chunk.data, chunk.size, alignof(std::max_align_t));
+        }
+    }
+
+    Mark mark() const { return Mark{current, offset, in_use}; }
+
+    // Free everything allocated after m (chunks are retained)
+    void rewind(const Mark& m) {
+        current = m.chunk;
+        offset = m.offset;
+        in_use = m.in_use;
+    }
+
+    // Free everything (chunks are retained)
+    void reset() { rewind(Mark{0, 0, 0}); }
+
+    size_t bytesInUse() const { return in_use; }
+    size_t highWaterMark() const { return high_water; }
+    size_t bytesReserved() const { return capacity; }
+    size_t upstreamAllocations() const { return upstream_allocations; }
+    void resetHighWaterMark() { high_water = in_use; }
+
+    void printStats(const char* label) const {
+        std::cout << label << ": high-water " << high_water << " bytes, "
+                  << capacity << " bytes reserved in " << chunks.size()
+                  << " chunk(s)" << std::endl;
+    }
+};
+
+// Rewinds an arena to where it was when the scope was entered
+class ArenaScope {
+private:
+    Arena& arena;
+    Arena::Mark saved;
+
+public:
+    explicit ArenaScope(Arena& a) : arena(a), saved(a.mark()) {}
+    ~ArenaScope() { arena.rewind(saved); }
+
+    ArenaScope(const ArenaScope&) = delete;
+    ArenaScope& operator=(const ArenaScope&) = delete;
+};
+
+// Per-thread scratch arena used by the library's transient buffers. Being
+// thread-local, parallel kernels never contend on it.
+inline Arena& scratchArena() {
+    thread_local Arena arena;
+    return arena;
+}
+
+#endif // ARENA_H
@@ -0,0 +1,168 @@
+#ifndef ASYNC_PROVER_H
+#define ASYNC_PROVER_H
+
+#include "field.h"
+#include "qap.h"
+#include "zksnark.h"
+#include "parallel.h"
+#include <vector>
+#include <memory>
+#include <future>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <exception>
+#include <algorithm>
+#include <cstddef>
+
+// Asynchronous prover: each proof is a small task graph over the stages of
+// Groth16::prove, run on ThreadPool::shared(), the pool the parallel
+// kernels inside each stage use too, so one set of threads serves every
+// job in flight. Threads waiting in a parallelFor run queued stage tasks.
+//
+//   start ──┬── quotient ── H sum ──┐
+//           ├── A sum ──────────────┤
+//           ├── B sum ──────────────┼── finish -> future<Proof>
+//           └── L sum ──────────────┘
+//
+// start checks the witness and draws the blinding factors; the quotient
+// (interpolation and the NTT-based division by Z) runs alongside the three
+// witness MSMs, and only the H sum waits for it. Tasks of successive jobs
+// share the queue, so one job's MSMs run while the next job's quotient
+// starts. No task blocks on another: the last of the four sums to finish
+// assembles the proof.
+//
+// submit() blocks while max_in_flight jobs are pending, which bounds the
+// memory held by queued witnesses and intermediate polynomials. Key is
+// ProvingKey or MappedProvingKey; the QAP and key must outlive the prover.
+template <typename Key = ProvingKey>
+class AsyncProver {
+private:
+    using Prover = Groth16<typename Key::Backend>;
+    using Proof = typename Prover::Proof;
+
+    struct Job {
+        typename Prover::ProverJob state;
+        std::vector<FieldElement> witness;
+        std::promise<Proof> result;
+        std::atomic<size_t> pending_sums;
+        std::mutex error_mutex;
+        std::exception_ptr error;
+
+        Job() : pending_sums(KEY_SECTION_COUNT) {}
+    };
+
+    const QAP& qap;
+    const Key& pk;
+    size_t max_in_flight;
+    size_t in_flight;
+    std::mutex mutex;
+    std::condition_variable changed;
+    ThreadPool& pool;
+
+    void fail(Job& job) {
+        std::lock_guard<std::mutex> lock(job.error_mutex);
+        if (!job.error) job.error = std::current_exception();
+    }
+
+    // Notifies under the lock: once wait() sees zero the prover may be
+    // destroyed, and the pool thread must not touch it after unlocking
+    void release() {
+        std::lock_guard<std::mutex> lock(mutex);
+        in_flight--;
+        changed.notify_all();
+    }
+
+    void start(std::shared_ptr<Job> job) {
+        try {
+            Prover::startProof(qap, pk, job->witness, job->state);
+            job->witness.clear();
+            job->witness.shrink_to_fit();
+        } catch (...) {
+            job->result.set_exception(std::current_exception());
+            release();
+            return;
+        }
+        pool.submit([this, job]() { quotient(job); });
+        for (KeySection section : {KeySection::A, KeySection::B, KeySection::L}) {
+            pool.submit([this, job, section]() { querySum(job, section); });
+        }
+    }
+
+    void quotient(std::shared_ptr<Job> job) {
+        try {
+            Prover::computeQuotient(qap, pk, job->state);
+        } catch (...) {
+            fail(*job);
+            sumDone(job);    // the H sum will not run
+            return;
+        }
+        pool.submit([this, job]() { querySum(job, KeySection::H); });
+    }
+
+    void querySum(std::shared_ptr<Job> job, KeySection section) {
+        try {
+            Prover::computeQuerySum(pk, section, job->state);
+        } catch (...) {
+            fail(*job);
+        }
+        sumDone(job);
+    }
+
+    // The last sum to land finishes the proof
+    void sumDone(const std::shared_ptr<Job>& job) {
+        if (job->pending_sums.fetch_sub(1) != 1) return;
+        if (job->error) {
+            job->result.set_exception(job->error);
+        } else {
+            try {
+                job->result.set_value(Prover::finishProof(pk, job->state));
+            } catch (...) {
+                job->result.set_exception(std::current_exception());
+            }
+        }
+        release();
+    }
+
+public:
+    AsyncProver(const QAP& qap, const Key& pk, size_t max_in_flight = 4)
+        : qap(qap), pk(pk), max_in_flight(std::max<size_t>(max_in_flight, 1)), in_flight(0),
+          pool(ThreadPool::shared()) {}
+
+    // Waits for the jobs still in flight; their futures stay valid
+    ~AsyncProver() {
+        wait();
+    }
+
+    AsyncProver(const AsyncProver&) = delete;
+    AsyncProver& operator=(const AsyncProver&) = delete;
+
+    // Queue one proof. An invalid witness surfaces as the future's exception
+    std::future<Proof> submit(std::vector<FieldElement> witness) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            changed.wait(lock, [this]() { return in_flight < max_in_flight; });
+            in_flight++;
+        }
+        auto job = std::make_shared<Job>();
+        job->witness = std::move(witness);
+        std::future<Proof> future = job->result.get_future();
+        pool.submit([this, job]() { start(job); });
+        return future;
+    }
+
+    // Block until every submitted job has finished
+    void wait() {
+        std::unique_lock<std::mutex> lock(mutex);
+        changed.wait(lock, [this]() { return in_flight == 0; });
+    }
+
+    size_t inFlight() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return in_flight;
+    }
+
+    size_t threads() const { return pool.size(); }
+};
+
+#endif // ASYNC_PROVER_H
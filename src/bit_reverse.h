@@ -0,0 +1,183 @@
+#ifndef BIT_REVERSE_H
+#define BIT_REVERSE_H
+
+#include "parallel.h"
+#include "arena.h"
+#include <array>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <stdexcept>
+#include <cstdint>
+
+// Bit-reversal permutation for radix-2 transforms.
+//
+// The textbook swap loop pairs i with rev(i); once the array outgrows the
+// cache nearly every swap misses twice, because rev(i) jumps across the
+// whole array. The kernels here use COBRA (Carter and Gatlin) blocking:
+// write the index as [a | m | c] with B-bit a and c, so that
+//   rev([a | m | c]) = [rev(c) | rev(m) | rev(a)]
+// For a fixed middle m, the 2^B x 2^B tile x[a, m, *] is read as 2^B
+// contiguous runs, transposed (with both B-bit halves reversed) in an
+// L1-resident buffer, and written as 2^B contiguous runs at middle rev(m).
+// Tiles are independent and are spread over the thread pool.
+//
+// Transforms that can pair a decimation-in-frequency pass (natural order
+// in, bit-reversed out) with a decimation-in-time pass (bit-reversed in,
+// natural out) need no permutation at all; see CM31Transform::multiply.
+
+namespace bit_reverse_detail {
+
+constexpr std::array<uint8_t, 256> makeByteTable() {
+    std::array<uint8_t, 256> table{};
+    for (unsigned i = 0; i < 256; i++) {
+        unsigned r = 0;
+        for (unsigned b = 0; b < 8; b++) {
+            r |= ((i >> b) & 1u) << (7 - b);
+        }
+        table[i] = static_cast<uint8_t>(r);
+    }
+    return table;
+}
+
+constexpr std::array<uint8_t, 256> BYTE_TABLE = makeByteTable();
+
+// Tile side is 2^TILE_BITS; a tile of 8-byte elements is 8 KB
+constexpr unsigned TILE_BITS = 5;
+
+// Below this many bits the whole array fits in cache and the swap loop wins
+constexpr unsigned BLOCKED_MIN_BITS = 2 * TILE_BITS + 2;
+
+} // namespace bit_reverse_detail
+
+// Reverse the low `bits` bits of value
+inline size_t reverseBits(size_t value, unsigned bits) {
+    if (bits == 0) return 0;
+    uint64_t v = value;
+    uint64_t r = 0;
+    for (unsigned byte = 0; byte < 8; byte++) {
+        r = (r << 8) | bit_reverse_detail::BYTE_TABLE[(v >> (8 * byte)) & 0xFF];
+    }
+    return static_cast<size_t>(r >> (64 - bits));
+}
+
+// log2 of a power-of-two size
+inline unsigned bitReverseLog(size_t n) {
+    unsigned log_n = 0;
+    while ((size_t(1) << log_n) < n) log_n++;
+    if ((size_t(1) << log_n) != n) {
+        throw std::runtime_error("Bit-reversal permutation needs a power-of-two size");
+    }
+    return log_n;
+}
+
+// In-place permutation x[i] <-> x[rev(i)]
+template <typename T>
+void bitReversePermute(T* x, size_t n) {
+    using namespace bit_reverse_detail;
+    unsigned log_n = bitReverseLog(n);
+
+    if (log_n < BLOCKED_MIN_BITS) {
+        for (size_t i = 1, j = 0; i < n; i++) {
+            size_t bit = n >> 1;
+            for (; j & bit; bit >>= 1) j ^= bit;
+            j ^= bit;
+            if (i < j) std::swap(x[i], x[j]);
+        }
+        return;
+    }
+
+    const size_t side = size_t(1) << TILE_BITS;
+    const unsigned mid_bits = log_n - 2 * TILE_BITS;
+    const unsigned high_shift = log_n - TILE_BITS;
+    std::array<uint8_t, side> rev_low;
+    for (size_t i = 0; i < side; i++) rev_low[i] = static_cast<uint8_t>(reverseBits(i, TILE_BITS));
+
+    parallelFor(0, size_t(1) << mid_bits, 16, [&](size_t lo, size_t hi) {
+        ArenaScope scope(scratchArena());
+        std::pmr::vector<T> tile(side * side, &scratchArena());
+        std::pmr::vector<T> partner(side * side, &scratchArena());
+
+        // tile[rev(c)][rev(a)] = x[a, m, c]: rows of the buffer are the
+        // destination runs
+        auto load = [&](std::pmr::vector<T>& buffer, size_t m) {
+            for (size_t a = 0; a < side; a++) {
+                const T* src = x + ((a << high_shift) | (m << TILE_BITS));
+                size_t column = rev_low[a];
+                for (size_t c = 0; c < side; c++) {
+                    buffer[rev_low[c] * side + column] = src[c];
+                }
+            }
+        };
+        auto store = [&](const std::pmr::vector<T>& buffer, size_t m) {
+            for (size_t r = 0; r < side; r++) {
+                T* dst = x + ((r << high_shift) | (m << TILE_BITS));
+                std::copy(buffer.begin() + r * side, buffer.begin() + (r + 1) * side, dst);
+            }
+        };
+
+        for (size_t m = lo; m < hi; m++) {
+            size_t m_rev = reverseBits(m, mid_bits);
+            if (m_rev < m) continue; // handled together with m_rev
+            load(tile, m);
+            if (m_rev != m) {
+                load(partner, m_rev);
+                store(partner, m);
+            }
+            store(tile, m_rev);
+        }
+    });
+}
+
+template <typename T>
+void bitReversePermute(std::vector<T>& v) {
+    bitReversePermute(v.data(), v.size());
+}
+
+// Out-of-place permutation out[rev(i)] = in[i]; in and out must not overlap
+template <typename T>
+void bitReverseCopy(const T* in, T* out, size_t n) {
+    using namespace bit_reverse_detail;
+    unsigned log_n = bitReverseLog(n);
+
+    if (log_n < BLOCKED_MIN_BITS) {
+        for (size_t i = 0; i < n; i++) {
+            out[reverseBits(i, log_n)] = in[i];
+        }
+        return;
+    }
+
+    const size_t side = size_t(1) << TILE_BITS;
+    const unsigned mid_bits = log_n - 2 * TILE_BITS;
+    const unsigned high_shift = log_n - TILE_BITS;
+    std::array<uint8_t, side> rev_low;
+    for (size_t i = 0; i < side; i++) rev_low[i] = static_cast<uint8_t>(reverseBits(i, TILE_BITS));
+
+    parallelFor(0, size_t(1) << mid_bits, 16, [&](size_t lo, size_t hi) {
+        ArenaScope scope(scratchArena());
+        std::pmr::vector<T> tile(side * side, &scratchArena());
+        for (size_t m = lo; m < hi; m++) {
+            for (size_t a = 0; a < side; a++) {
+                const T* src = in + ((a << high_shift) | (m << TILE_BITS));
+                size_t column = rev_low[a];
+                for (size_t c = 0; c < side; c++) {
+                    tile[rev_low[c] * side + column] = src[c];
+                }
+            }
+            size_t m_rev = reverseBits(m, mid_bits);
+            for (size_t r = 0; r < side; r++) {
+                T* dst = out + ((r << high_shift) | (m_rev << TILE_BITS));
+                std::copy(tile.begin() + r * side, tile.begin() + (r + 1) * side, dst);
+            }
+        }
+    });
+}
+
+template <typename T>
+std::vector<T> bitReverseCopy(const std::vector<T>& in) {
+    std::vector<T> out(in.size());
+    bitReverseCopy(in.data(), out.data(), in.size());
+    return out;
+}
+
+#endif // BIT_REVERSE_H
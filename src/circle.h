@@ -0,0 +1,307 @@
+#ifndef CIRCLE_H
+#define CIRCLE_H
+
+#include "field.h"
+#include "parallel.h"
+#include "bit_reverse.h"
+#include <vector>
+#include <memory>
+#include <iostream>
+#include <stdexcept>
+#include <cstdint>
+
+// Point on the circle x^2 + y^2 = 1 over the field.
+//
+// The points form a group under
+//   (x1, y1) * (x2, y2) = (x1*x2 - y1*y2, x1*y2 + y1*x2)
+// (multiplication of x + iy on the unit circle). For p = 2^31 - 1 the group
+// has order p + 1 = 2^31, so it has a subgroup of every power-of-two size.
+// The multiplicative group only has 2-adicity 1, so the circle group is
+// where this field gets its radix-2 FFT domains.
+class CirclePoint {
+public:
+    FieldElement x, y;
+
+    static constexpr unsigned LOG_ORDER = 31;
+
+    CirclePoint() : x(1), y(0) {} // identity
+    CirclePoint(const FieldElement& x_val, const FieldElement& y_val) : x(x_val), y(y_val) {}
+
+    CirclePoint operator*(const CirclePoint& other) const {
+        return CirclePoint(x * other.x - y * other.y, x * other.y + y * other.x);
+    }
+
+    // Inverse; geometrically the reflection J(x, y) = (x, -y)
+    CirclePoint conjugate() const { return CirclePoint(x, FieldElement(0) - y); }
+
+    // P * P = (2x^2 - 1, 2xy). On x-coordinates this is the map
+    // pi(x) = 2x^2 - 1 that halves circle FFT domains.
+    CirclePoint square() const {
+        return CirclePoint(x * x * FieldElement(2) - FieldElement(1), x * y * FieldElement(2));
+    }
+
+    CirclePoint power(uint64_t exp) const {
+        CirclePoint result;
+        CirclePoint base = *this;
+        while (exp > 0) {
+            if (exp & 1) result = result * base;
+            base = base.square();
+            exp >>= 1;
+        }
+        return result;
+    }
+
+    bool isOnCircle() const { return x * x + y * y == FieldElement(1); }
+
+    bool operator==(const CirclePoint& other) const { return x == other.x && y == other.y; }
+    bool operator!=(const CirclePoint& other) const { return !(*this == other); }
+
+    // Generator of the whole circle group (order 2^31)
+    static CirclePoint generator() { return CirclePoint(FieldElement(2), FieldElement(1268011823)); }
+
+    // Generator of the subgroup G_k of order 2^log_order
+    static CirclePoint subgroupGenerator(unsigned log_order) {
+        if (log_order > LOG_ORDER) {
+            throw std::runtime_error("Circle group has no subgroup of order 2^" + std::to_string(log_order));
+        }
+        return generator().power(uint64_t(1) << (LOG_ORDER - log_order));
+    }
+
+    friend std::ostream& operator<<(std::ostream& os, const CirclePoint& p) {
+        os << "(" << p.x << ", " << p.y << ")";
+        return os;
+    }
+};
+
+// Circle FFT domain of size N = 2^n: the twin coset
+//   D = Q * G_{n-1}  union  Q^-1 * G_{n-1}
+// where G_{n-1} is the circle subgroup of order N/2. D is closed under
+// J(x, y) = (x, -y), and its x-coordinates halve under pi(x) = 2x^2 - 1 at
+// every step, which is what the circle FFT recurses on. The canonic coset
+// (Q of order 2N) is the usual choice, and is itself a coset of G_n.
+//
+// Polynomials live in the circle FFT basis
+//   b_j(x, y) = y^j0 * x^j1 * pi(x)^j2 * pi(pi(x))^j3 * ...
+// (j0, j1, ... are the bits of j). The basis does not depend on the domain,
+// and the basis for N points is a prefix of the basis for 2N points. A low-
+// degree extension is therefore an inverse FFT on a small domain followed
+// by a forward FFT of the zero-padded coefficients on a large one.
+//
+// Point order: index i < N/2 is Q * g^i, and index i + N/2 is its twin
+// J(Q * g^i). Coefficients are in natural order (coefficient j of b_j).
+class CircleDomain {
+private:
+    // Per-layer twiddles: layer 0 holds the y-coordinates of the first N/2
+    // points, layer k >= 1 the x-coordinates of the first half of the k-th
+    // projected domain. Shared between copies of a domain.
+    struct Twiddles {
+        std::vector<std::vector<FieldElement>> forward;
+        std::vector<std::vector<FieldElement>> inverse;
+    };
+
+    unsigned log_n;
+    size_t n;
+    CirclePoint initial; // Q
+    CirclePoint step;    // generator of G_{n-1}
+    std::shared_ptr<const Twiddles> twiddles;
+
+    void buildTwiddles() {
+        auto tw = std::make_shared<Twiddles>();
+
+        // First half of D: Q * g^i
+        std::vector<CirclePoint> current(n / 2);
+        CirclePoint p = initial;
+        for (size_t i = 0; i < n / 2; i++) {
+            current[i] = p;
+            p = p * step;
+        }
+
+        std::vector<FieldElement> layer(n / 2);
+        for (size_t i = 0; i < n / 2; i++) layer[i] = current[i].y;
+        tw->forward.push_back(layer);
+
+        // Projected domain k is x(Q^(2^(k-1)) * g^(2^(k-1) * i)); its point i
+        // pairs with i + half through x -> -x, and squaring the first half
+        // gives the next projected domain
+        while (current.size() > 1) {
+            size_t half = current.size() / 2;
+            layer.resize(half);
+            for (size_t i = 0; i < half; i++) {
+                layer[i] = current[i].x;
+                current[i] = current[i].square();
+            }
+            current.resize(half);
+            tw->forward.push_back(layer);
+        }
+
+        tw->inverse = tw->forward;
+        for (auto& values : tw->inverse) {
+            for (const auto& v : values) {
+                if (v == FieldElement(0)) {
+                    throw std::runtime_error("Twin coset is degenerate (a coordinate vanishes)");
+                }
+            }
+            FieldElement::batchInvert(values);
+        }
+        twiddles = tw;
+    }
+
+    // One butterfly layer over blocks of m values, m/2 butterflies each.
+    // Forward:  (a, b) -> (a + t*b, a - t*b)
+    // Inverse:  (a, b) -> (a + b, (a - b) / t)
+    static void butterflies(std::vector<FieldElement>& v, size_t m,
+                            const std::vector<FieldElement>& tw, bool inverse) {
+        size_t half = m / 2;
+        parallelFor(0, v.size() / 2, 1 << 12, [&](size_t lo, size_t hi) {
+            for (size_t t = lo; t < hi; t++) {
+                size_t i = t % half;
+                size_t s = (t / half) * m;
+                FieldElement a = v[s + i];
+                FieldElement b = v[s + i + half];
+                if (inverse) {
+                    v[s + i] = a + b;
+                    v[s + i + half] = (a - b) * tw[i];
+                } else {
+                    FieldElement tb = b * tw[i];
+                    v[s + i] = a + tb;
+                    v[s + i + half] = a - tb;
+                }
+            }
+        });
+    }
+
+    CircleDomain() : log_n(0), n(0) {}
+
+public:
+    // Twin coset Q * G_{n-1} union Q^-1 * G_{n-1} with N = 2^log_size points
+    static CircleDomain twinCoset(const CirclePoint& q, unsigned log_size) {
+        if (log_size == 0 || log_size >= CirclePoint::LOG_ORDER) {
+            throw std::runtime_error("Circle domain size must be 2^1 .. 2^30");
+        }
+        if (!q.isOnCircle()) {
+            throw std::runtime_error("Twin coset offset is not on the circle");
+        }
+
+        CircleDomain domain;
+        domain.log_n = log_size;
+        domain.n = size_t(1) << log_size;
+        domain.initial = q;
+        domain.step = CirclePoint::subgroupGenerator(log_size - 1);
+        domain.buildTwiddles();
+        return domain;
+    }
+
+    // Canonic coset of size 2^log_size: Q of order 2^(log_size + 1)
+    static CircleDomain canonic(unsigned log_size) {
+        return twinCoset(CirclePoint::subgroupGenerator(log_size + 1), log_size);
+    }
+
+    // Smallest canonic coset holding at least min_size points
+    static CircleDomain canonicFor(size_t min_size) {
+        unsigned log_size = 1;
+        while ((size_t(1) << log_size) < min_size) log_size++;
+        return canonic(log_size);
+    }
+
+    size_t size() const { return n; }
+    unsigned logSize() const { return log_n; }
+    CirclePoint offset() const { return initial; }
+
+    // i-th point of the domain
+    CirclePoint point(size_t i) const {
+        if (i < n / 2) return initial * step.power(i);
+        return (initial * step.power(i - n / 2)).conjugate();
+    }
+
+    std::vector<CirclePoint> points() const {
+        std::vector<CirclePoint> result(n);
+        CirclePoint p = initial;
+        for (size_t i = 0; i < n / 2; i++) {
+            result[i] = p;
+            result[i + n / 2] = p.conjugate();
+            p = p * step;
+        }
+        return result;
+    }
+
+    // Circle FFT: evaluate a polynomial given by up to N circle-basis
+    // coefficients at every point of the domain. O(N log N).
+    std::vector<FieldElement> fft(const std::vector<FieldElement>& coeffs) const {
+        if (coeffs.size() > n) {
+            throw std::runtime_error("Too many coefficients for this circle domain");
+        }
+        std::vector<FieldElement> padded = coeffs;
+        padded.resize(n, FieldElement(0));
+        std::vector<FieldElement> v = bitReverseCopy(padded);
+
+        // Line layers from the smallest projected domain up, then the circle layer
+        for (size_t k = twiddles->forward.size(); k-- > 0;) {
+            butterflies(v, n >> (k == 0 ? 0 : k), twiddles->forward[k], false);
+        }
+        return v;
+    }
+
+    // Inverse circle FFT: circle-basis coefficients of the unique
+    // polynomial in the span of b_0 .. b_{N-1} taking the given values
+    std::vector<FieldElement> ifft(const std::vector<FieldElement>& evals) const {
+        if (evals.size() != n) {
+            throw std::runtime_error("Number of evaluations must equal the circle domain size");
+        }
+        std::vector<FieldElement> v = evals;
+
+        // f(x, y) = f0(x) + y * f1(x), then g(x) = g0(pi(x)) + x * g1(pi(x)).
+        // The halvings are collected into one final 1/N.
+        for (size_t k = 0; k < twiddles->inverse.size(); k++) {
+            butterflies(v, n >> (k == 0 ? 0 : k), twiddles->inverse[k], true);
+        }
+
+        FieldElement n_inv = FieldElement(n).inverse();
+        bitReversePermute(v);
+        for (auto& c : v) c = c * n_inv;
+        return v;
+    }
+
+    // Low-degree extension: re-evaluate evaluations on this domain over a
+    // (larger) target domain
+    std::vector<FieldElement> extend(const std::vector<FieldElement>& evals, const CircleDomain& target) const {
+        if (target.size() < n) {
+            throw std::runtime_error("Low-degree extension target is smaller than the source domain");
+        }
+        return target.fft(ifft(evals));
+    }
+
+    // Evaluate circle-basis coefficients at any point on the circle: O(N)
+    static FieldElement evaluateAt(const std::vector<FieldElement>& coeffs, const CirclePoint& p) {
+        if (coeffs.empty()) return FieldElement(0);
+
+        size_t size = 1;
+        unsigned bits = 0;
+        while (size < coeffs.size()) {
+            size <<= 1;
+            bits++;
+        }
+        std::vector<FieldElement> folded(coeffs);
+        folded.resize(size, FieldElement(0));
+
+        // Bit b >= 1 of j multiplies by pi^(b-1)(x); fold the highest bit first
+        std::vector<FieldElement> factors;
+        FieldElement t = p.x;
+        for (unsigned b = 1; b < bits; b++) {
+            factors.push_back(t);
+            t = t * t * FieldElement(2) - FieldElement(1);
+        }
+        for (unsigned b = bits; b-- > 1;) {
+            size_t half = size_t(1) << b;
+            for (size_t i = 0; i < half; i++) {
+                folded[i] = folded[i] + factors[b - 1] * folded[i + half];
+            }
+        }
+        return (bits == 0) ? folded[0] : folded[0] + p.y * folded[1];
+    }
+
+    void print() const {
+        std::cout << "circle twin coset of size " << n << " (offset " << initial << ")";
+    }
+};
+
+#endif // CIRCLE_H
@@ -0,0 +1,233 @@
+#ifndef CM31_H
+#define CM31_H
+
+#include "field.h"
+#include "circle.h"
+#include "polynomial.h"
+#include "parallel.h"
+#include "bit_reverse.h"
+#include <vector>
+#include <iostream>
+#include <stdexcept>
+#include <cstdint>
+
+// Complex extension CM31 = F_p[i] / (i^2 + 1) of the base field.
+//
+// p = 2^31 - 1 is 3 mod 4, so i^2 = -1 has no root in F_p and this is a
+// field of p^2 elements. Its multiplicative group has order
+// p^2 - 1 = (p - 1)(p + 1), divisible by 2^32, so plain radix-2 FFTs exist
+// here even though F_p itself has 2-adicity 1. The elements of norm 1
+// (a^2 + b^2 = 1) are exactly the circle group, and its generator gives the
+// power-of-two roots of unity.
+class CM31 {
+public:
+    FieldElement real, imag;
+
+    CM31() : real(0), imag(0) {}
+    CM31(const FieldElement& re) : real(re), imag(0) {}
+    CM31(const FieldElement& re, const FieldElement& im) : real(re), imag(im) {}
+    explicit CM31(const CirclePoint& p) : real(p.x), imag(p.y) {}
+
+    CM31 operator+(const CM31& other) const { return CM31(real + other.real, imag + other.imag); }
+    CM31 operator-(const CM31& other) const { return CM31(real - other.real, imag - other.imag); }
+
+    // Karatsuba: three base products, no branches, all reductions deferred
+    // to the end. Each lane is independent straight-line integer code that
+    // auto-vectorises across arrays of CM31.
+    //   re = ac - bd,  im = (a + b)(c + d) - ac - bd
+    CM31 operator*(const CM31& other) const {
+        uint64_t a = real.getValue(), b = imag.getValue();
+        uint64_t c = other.real.getValue(), d = other.imag.getValue();
+        uint64_t ac = FieldElement::foldProduct(a * c);             // < 2^32
+        uint64_t bd = FieldElement::foldProduct(b * d);             // < 2^32
+        uint64_t cross = FieldElement::foldProduct((a + b) * (c + d)); // < 2^34
+        const uint64_t bias = 4 * FieldElement::getPrime();          // multiple of p above 2^32 + 2^32
+        return CM31(FieldElement(ac + bias - bd), FieldElement(cross + 2 * bias - ac - bd));
+    }
+
+    CM31 operator*(const FieldElement& scalar) const { return CM31(real * scalar, imag * scalar); }
+
+    CM31 conjugate() const { return CM31(real, FieldElement(0) - imag); }
+
+    // a^2 + b^2, in the base field
+    FieldElement norm() const { return real * real + imag * imag; }
+
+    CM31 inverse() const {
+        FieldElement n = norm();
+        if (n == FieldElement(0)) {
+            throw std::runtime_error("Division by zero in CM31");
+        }
+        return conjugate() * n.inverse();
+    }
+
+    CM31 power(uint64_t exp) const {
+        CM31 result(FieldElement(1));
+        CM31 base = *this;
+        while (exp > 0) {
+            if (exp & 1) result = result * base;
+            base = base * base;
+            exp >>= 1;
+        }
+        return result;
+    }
+
+    bool operator==(const CM31& other) const { return real == other.real && imag == other.imag; }
+    bool operator!=(const CM31& other) const { return !(*this == other); }
+
+    friend std::ostream& operator<<(std::ostream& os, const CM31& z) {
+        os << z.real << " + " << z.imag << "i";
+        return os;
+    }
+
+    // Largest power-of-two FFT size used here (roots come from the circle group)
+    static constexpr unsigned MAX_LOG_SIZE = CirclePoint::LOG_ORDER;
+
+    // Primitive n-th root of unity for n = 2^k, k <= 31. It has norm 1,
+    // so its conjugate is its inverse.
+    static CM31 rootOfUnity(uint64_t n) {
+        unsigned log_n = 0;
+        while ((uint64_t(1) << log_n) < n) log_n++;
+        if ((uint64_t(1) << log_n) != n || log_n > MAX_LOG_SIZE) {
+            throw std::runtime_error("CM31 has no root of unity of order " + std::to_string(n));
+        }
+        return CM31(CirclePoint::subgroupGenerator(log_n));
+    }
+};
+
+// Radix-2 NTT over CM31, used to multiply base-field polynomials
+class CM31Transform {
+private:
+    size_t n;
+    unsigned log_n;
+    std::vector<CM31> roots; // w^i for i < N/2
+
+    // Decimation in time: bit-reversed input, natural-order output
+    void ditPasses(std::vector<CM31>& v, bool inverse) const {
+        for (size_t len = 2; len <= n; len <<= 1) {
+            size_t half = len / 2;
+            size_t stride = n / len;
+            parallelFor(0, n / 2, 1 << 12, [&](size_t lo, size_t hi) {
+                for (size_t t = lo; t < hi; t++) {
+                    size_t j = t % half;
+                    size_t s = (t / half) * len;
+                    CM31 w = inverse ? roots[j * stride].conjugate() : roots[j * stride];
+                    CM31 u = v[s + j];
+                    CM31 x = v[s + j + half] * w;
+                    v[s + j] = u + x;
+                    v[s + j + half] = u - x;
+                }
+            });
+        }
+    }
+
+    // Decimation in frequency: natural-order input, bit-reversed output
+    void difPasses(std::vector<CM31>& v, bool inverse) const {
+        for (size_t len = n; len >= 2; len >>= 1) {
+            size_t half = len / 2;
+            size_t stride = n / len;
+            parallelFor(0, n / 2, 1 << 12, [&](size_t lo, size_t hi) {
+                for (size_t t = lo; t < hi; t++) {
+                    size_t j = t % half;
+                    size_t s = (t / half) * len;
+                    CM31 w = inverse ? roots[j * stride].conjugate() : roots[j * stride];
+                    CM31 u = v[s + j];
+                    CM31 x = v[s + j + half];
+                    v[s + j] = u + x;
+                    v[s + j + half] = (u - x) * w;
+                }
+            });
+        }
+    }
+
+    void scaleInverse(std::vector<CM31>& v) const {
+        FieldElement n_inv = FieldElement(n).inverse();
+        for (auto& z : v) z = z * n_inv;
+    }
+
+public:
+    explicit CM31Transform(size_t size) : n(size), log_n(0) {
+        while ((size_t(1) << log_n) < n) log_n++;
+        if ((size_t(1) << log_n) != n) {
+            throw std::runtime_error("CM31 transform size must be a power of two");
+        }
+        CM31 w = CM31::rootOfUnity(n);
+        roots.resize(n / 2);
+        CM31 r(FieldElement(1));
+        for (size_t i = 0; i < n / 2; i++) {
+            roots[i] = r;
+            r = r * w;
+        }
+    }
+
+    size_t size() const { return n; }
+
+    // Smallest transform size holding min_size values
+    static size_t sizeFor(size_t min_size) {
+        size_t size = 1;
+        while (size < min_size) size <<= 1;
+        return size;
+    }
+
+    // In-place iterative Cooley-Tukey; the inverse uses conjugate roots
+    // (w^-1 = conj(w) on the circle) and scales by 1/N
+    void transform(std::vector<CM31>& v, bool inverse) const {
+        bitReversePermute(v);
+        ditPasses(v, inverse);
+        if (inverse) scaleInverse(v);
+    }
+
+    // Forward transform leaving the spectrum in bit-reversed order:
+    // position p holds X[rev(p)]
+    void forwardBitReversed(std::vector<CM31>& v) const {
+        difPasses(v, false);
+    }
+
+    // Inverse of forwardBitReversed: bit-reversed spectrum in, natural-order
+    // values out. Paired with it, neither direction needs a permutation.
+    void inverseFromBitReversed(std::vector<CM31>& v) const {
+        ditPasses(v, true);
+        scaleInverse(v);
+    }
+
+    // Product of two base-field polynomials with one forward and one
+    // inverse transform: both real operands are packed into Z = A + iB.
+    // For real input the spectrum is conjugate-symmetric, X[-k] = conj(X[k]),
+    // so A^[k] = (Z^[k] + conj(Z^[-k])) / 2 and B^[k] = (Z^[k] - conj(Z^[-k])) / 2i.
+    static Polynomial multiply(const Polynomial& a, const Polynomial& b) {
+        if (a.coefficients.empty() || b.coefficients.empty()) {
+            return Polynomial();
+        }
+        size_t product_size = a.coefficients.size() + b.coefficients.size() - 1;
+        CM31Transform fft(sizeFor(product_size));
+        size_t n = fft.size();
+
+        std::vector<CM31> z(n);
+        for (size_t k = 0; k < a.coefficients.size(); k++) z[k].real = a.coefficients[k];
+        for (size_t k = 0; k < b.coefficients.size(); k++) z[k].imag = b.coefficients[k];
+        // DIF forward and DIT inverse: the spectrum stays in bit-reversed
+        // order in between, so no permutation pass is needed
+        fft.forwardBitReversed(z);
+
+        // A^ * B^ = (Z[k]^2 - conj(Z[-k])^2) / 4i, with Z[k] at position rev(k)
+        const CM31 quarter_over_i = CM31(FieldElement(0), FieldElement(4)).inverse();
+        unsigned log_n = fft.log_n;
+        std::vector<CM31> product(n);
+        parallelFor(0, n, 1 << 12, [&](size_t lo, size_t hi) {
+            for (size_t p = lo; p < hi; p++) {
+                size_t k = reverseBits(p, log_n);
+                CM31 zk = z[p];
+                CM31 zm = z[reverseBits((n - k) & (n - 1), log_n)].conjugate();
+                product[p] = (zk * zk - zm * zm) * quarter_over_i;
+            }
+        });
+        fft.inverseFromBitReversed(product);
+
+        std::vector<FieldElement> coeffs(product_size);
+        for (size_t k = 0; k < product_size; k++) {
+            coeffs[k] = product[k].real;
+        }
+        return Polynomial(std::move(coeffs));
+    }
+};
+
+#endif // CM31_H
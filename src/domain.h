@@ -0,0 +1,816 @@
+#ifndef DOMAIN_H
+#define DOMAIN_H
+
+#include "field.h"
+#include "polynomial.h"
+#include "sparse_polynomial.h"
+#include "arena.h"
+#include "parallel.h"
+#include "mapped_file.h"
+#include "twiddle.h"
+#include "cm31.h"
+#include <vector>
+#include <iostream>
+#include <stdexcept>
+#include <algorithm>
+#include <memory>
+
+// Evaluation domain: the points at which the R1CS constraints are placed
+// when the system is converted to a QAP.
+//
+// The preferred domain is a multiplicative subgroup H = {1, w, ..., w^(N-1)}.
+// Its vanishing polynomial is Z(x) = x^N - 1, so Z(r) costs one
+// exponentiation and every Lagrange basis polynomial can be evaluated at an
+// arbitrary point in O(N) total. A coset gH gives Z(x) = x^N - g^N.
+// Arbitrary points (e.g. the classic 1, 2, ..., m) are kept as a fallback.
+//
+// Over p = 2^31 - 1 the group order is p - 1 = 2 * 3^2 * 7 * 11 * 31 * 151 * 331,
+// so subgroup sizes are the divisors of p - 1 rather than powers of two, and
+// the NTT below is mixed-radix over those prime factors. Large domains use a
+// cache-blocked, multithreaded four-step variant.
+class EvaluationDomain {
+public:
+    enum class Kind { Subgroup, Coset, Arbitrary };
+
+private:
+    Kind kind;
+    size_t n;
+    FieldElement shift;                 // g (1 for a plain subgroup)
+    FieldElement shift_pow_n;           // g^N
+    FieldElement omega;                 // generator of H
+    std::shared_ptr<const TwiddleTable> twiddles; // w^i for i < N, shared by all domains of size N
+    std::vector<uint64_t> radices;      // prime factors of N, smallest first
+    std::vector<FieldElement> points;   // explicit points (arbitrary domains)
+    std::vector<FieldElement> weights;  // barycentric weights (arbitrary domains)
+    SparsePolynomial sparse_vanishing;  // Z(x) = x^N - g^N (subgroups and cosets)
+    Polynomial vanishing;               // Z(x) = prod (x - x_i) (arbitrary domains)
+    size_t four_step_threshold;         // sizes from here on use the four-step NTT
+
+    static std::vector<uint64_t> factorGroupOrder(uint64_t value) {
+        std::vector<uint64_t> factors;
+        for (uint64_t q = 2; q * q <= value; q++) {
+            while (value % q == 0) {
+                factors.push_back(q);
+                value /= q;
+            }
+        }
+        if (value > 1) factors.push_back(value);
+        return factors;
+    }
+
+    // Mixed-radix decimation-in-time NTT. The sub-transform of length `len`
+    // reads `in` with the given stride and uses the root w^step, where
+    // step = N / len. `column` is scratch space for max(radices) elements.
+    //
+    // Pruning: only the first in_count inputs may be non-zero (zero-padded
+    // operands skip whole sub-transforms) and only the first out_count
+    // outputs are produced (truncated transforms skip unneeded butterflies).
+    void nttRecursive(const FieldElement* in, size_t stride, FieldElement* out,
+                      size_t len, size_t step, size_t level, bool inverse,
+                      FieldElement* column,
+                      size_t in_count = SIZE_MAX, size_t out_count = SIZE_MAX) const {
+        in_count = std::min(in_count, len);
+        out_count = std::min(out_count, len);
+
+        if (in_count <= 1) {
+            // Constant input: every output equals in[0]
+            FieldElement value = (in_count == 1) ? in[0] : FieldElement(0);
+            for (size_t k = 0; k < out_count; k++) out[k] = value;
+            return;
+        }
+
+        uint64_t radix = radices[level];
+        size_t m = len / radix;
+        size_t k_end = std::min(m, out_count);
+
+        for (size_t r = 0; r < radix; r++) {
+            size_t sub_in = (in_count > r) ? (in_count - r + radix - 1) / radix : 0;
+            nttRecursive(in + r * stride, stride * radix, out + r * m,
+                         m, step * radix, level + 1, inverse, column, sub_in, k_end);
+        }
+
+        // w_radix = w_len^m, a primitive radix-th root of unity
+        size_t root_step = n / radix;
+        const TwiddleTable& table = *twiddles;
+        auto root = [&](size_t e) {
+            size_t idx = e * step;
+            if (inverse && idx != 0) idx = n - idx;
+            return idx;
+        };
+
+        for (size_t k = 0; k < k_end; k++) {
+            // Z_r = w_len^(r*k) * Y_r[k]; r*k < len, so r*k*step < N
+            column[0] = out[k];
+            for (size_t r = 1; r < radix; r++) {
+                column[r] = table.mul(out[r * m + k], root(r * k));
+            }
+
+            // Length-radix DFT of Z: X[k + q*m] = sum_r Z_r * w_radix^(r*q)
+            if (radix == 2) {
+                out[k] = column[0] + column[1];
+                if (k + m < out_count) out[k + m] = column[0] - column[1];
+            } else if (radix == 3) {
+                size_t w1 = root((len / 3));
+                size_t w2 = root(2 * (len / 3));
+                FieldElement z0 = column[0], z1 = column[1], z2 = column[2];
+                out[k] = z0 + z1 + z2;
+                if (k + m < out_count) out[k + m] = z0 + table.mul(z1, w1) + table.mul(z2, w2);
+                if (k + 2 * m < out_count) out[k + 2 * m] = z0 + table.mul(z1, w2) + table.mul(z2, w1);
+            } else {
+                for (size_t q = 0; q < radix && k + q * m < out_count; q++) {
+                    // Folded products are < 2^32, so a radix-331 sum fits in 64 bits
+                    uint64_t acc = column[0].getValue();
+                    for (size_t r = 1; r < radix; r++) {
+                        size_t idx = root_step * ((r * q) % radix);
+                        if (inverse && idx != 0) idx = n - idx;
+                        acc += FieldElement::foldProduct(column[r].getValue() * table.rootData()[idx].getValue());
+                    }
+                    out[k + q * m] = FieldElement(acc);
+                }
+            }
+        }
+    }
+
+    size_t maxRadix() const {
+        return radices.empty() ? 1 : *std::max_element(radices.begin(), radices.end());
+    }
+
+    // Number of leading radices forming N1 in the N = N1 * N2 split used by
+    // the four-step NTT, chosen so both factors are as close to sqrt(N) as
+    // the factorisation allows
+    size_t fourStepSplit() const {
+        size_t best = 1;
+        uint64_t best_cost = n;
+        uint64_t prefix = 1;
+        for (size_t s = 1; s < radices.size(); s++) {
+            prefix *= radices[s - 1];
+            uint64_t cost = std::max<uint64_t>(prefix, n / prefix);
+            if (cost < best_cost) {
+                best_cost = cost;
+                best = s;
+            }
+        }
+        return best;
+    }
+
+    // Four-step (Bailey) NTT for domains larger than the cache. The input is
+    // viewed as an N1 x N2 row-major matrix, M[j1][j2] = in[j1 * N2 + j2]:
+    //   1. length-N1 transforms down every column,
+    //   2. multiplication by w^(j2 * k1), fused into the column pass,
+    //   3. length-N2 transforms along every row,
+    //   4. transposition into the output, X[k1 + N1 * k2].
+    // Columns and rows are handled in blocks so every sub-transform works on
+    // contiguous data, and blocks are spread across the thread pool.
+    void nttFourStep(const FieldElement* in, FieldElement* out, bool inverse) const {
+        size_t split = fourStepSplit();
+        size_t n1 = 1;
+        for (size_t s = 0; s < split; s++) n1 *= radices[s];
+        size_t n2 = n / n1;
+        const size_t block = 16;
+
+        ArenaScope scope(scratchArena());
+        std::pmr::vector<FieldElement> work(n, &scratchArena());
+
+        // Steps 1 + 2: column transforms with the twiddle pass fused in
+        parallelFor(0, (n2 + block - 1) / block, 1, [&](size_t lo, size_t hi) {
+            ArenaScope thread_scope(scratchArena());
+            std::pmr::vector<FieldElement> gathered(block * n1, &scratchArena());
+            std::pmr::vector<FieldElement> transformed(n1, &scratchArena());
+            std::pmr::vector<FieldElement> column(maxRadix(), &scratchArena());
+
+            for (size_t blk = lo; blk < hi; blk++) {
+                size_t j2_begin = blk * block;
+                size_t width = std::min(block, n2 - j2_begin);
+
+                // Gather `width` columns, reading each row segment contiguously
+                for (size_t j1 = 0; j1 < n1; j1++) {
+                    const FieldElement* row = in + j1 * n2 + j2_begin;
+                    for (size_t b = 0; b < width; b++) {
+                        gathered[b * n1 + j1] = row[b];
+                    }
+                }
+
+                for (size_t b = 0; b < width; b++) {
+                    size_t j2 = j2_begin + b;
+                    nttRecursive(gathered.data() + b * n1, 1, transformed.data(),
+                                 n1, n2, 0, inverse, column.data());
+                    for (size_t k1 = 0; k1 < n1; k1++) {
+                        size_t idx = j2 * k1; // < N, no reduction needed
+                        if (inverse && idx != 0) idx = n - idx;
+                        work[k1 * n2 + j2] = twiddles->mul(transformed[k1], idx);
+                    }
+                }
+            }
+        });
+
+        // Steps 3 + 4: row transforms, written out transposed in blocks
+        parallelFor(0, (n1 + block - 1) / block, 1, [&](size_t lo, size_t hi) {
+            ArenaScope thread_scope(scratchArena());
+            std::pmr::vector<FieldElement> rows(block * n2, &scratchArena());
+            std::pmr::vector<FieldElement> column(maxRadix(), &scratchArena());
+
+            for (size_t blk = lo; blk < hi; blk++) {
+                size_t k1_begin = blk * block;
+                size_t height = std::min(block, n1 - k1_begin);
+
+                for (size_t b = 0; b < height; b++) {
+                    nttRecursive(work.data() + (k1_begin + b) * n2, 1, rows.data() + b * n2,
+                                 n2, n1, split, inverse, column.data());
+                }
+
+                for (size_t k2 = 0; k2 < n2; k2++) {
+                    FieldElement* dest = out + k1_begin + n1 * k2;
+                    for (size_t b = 0; b < height; b++) {
+                        dest[b] = rows[b * n2 + k2];
+                    }
+                }
+            }
+        });
+    }
+
+    // Four-step NTT over file-backed vectors, staging at most about
+    // memory_budget bytes at a time. Pass 1 transforms column blocks in
+    // place in `values`; pass 2 transforms row blocks and writes them
+    // transposed into `result`. Coset scaling (forward) and the 1/N and
+    // coset unscaling (inverse) are fused into those passes.
+    void transformOutOfCore(MappedVector<FieldElement>& values, MappedVector<FieldElement>& result,
+                            bool inverse, size_t memory_budget) const {
+        if (kind == Kind::Arbitrary) {
+            throw std::runtime_error("Out-of-core NTT needs a multiplicative domain");
+        }
+        if (values.size() != n || result.size() != n) {
+            throw std::runtime_error("Out-of-core NTT buffers must match the domain size");
+        }
+
+        size_t split = radices.size() > 1 ? fourStepSplit() : radices.size();
+        size_t n1 = 1;
+        for (size_t s = 0; s < split; s++) n1 *= radices[s];
+        size_t n2 = n / n1;
+        size_t elem = sizeof(FieldElement);
+        if (std::max(n1, n2) * elem > memory_budget) {
+            throw std::runtime_error("Memory budget too small for one row of the out-of-core NTT");
+        }
+
+        bool scaled = (shift != FieldElement(1));
+        FieldElement g = inverse ? shift.inverse() : shift;
+
+        // Pass 1: column transforms, in place
+        size_t width = std::min(n2, std::max<size_t>(1, memory_budget / (n1 * elem)));
+        {
+            ArenaScope scope(scratchArena());
+            std::pmr::vector<FieldElement> gathered(width * n1, &scratchArena());
+            FieldElement g_n2 = g.power(n2);
+
+            for (size_t j2_begin = 0; j2_begin < n2; j2_begin += width) {
+                size_t w = std::min(width, n2 - j2_begin);
+
+                // Start reading the next block while this one is processed
+                if (j2_begin + w < n2) {
+                    size_t next_w = std::min(width, n2 - j2_begin - w);
+                    for (size_t j1 = 0; j1 < n1; j1++) {
+                        values.prefetch(j1 * n2 + j2_begin + w, next_w);
+                    }
+                }
+
+                // Forward coset transform: scale by g^(j1 * n2 + j2) on the way in
+                FieldElement row_factor(1);
+                FieldElement col_start = g.power(j2_begin);
+                for (size_t j1 = 0; j1 < n1; j1++) {
+                    const FieldElement* row = values.data() + j1 * n2 + j2_begin;
+                    FieldElement factor = row_factor * col_start;
+                    for (size_t b = 0; b < w; b++) {
+                        if (scaled && !inverse) {
+                            gathered[b * n1 + j1] = row[b] * factor;
+                            factor = factor * g;
+                        } else {
+                            gathered[b * n1 + j1] = row[b];
+                        }
+                    }
+                    row_factor = row_factor * g_n2;
+                }
+
+                parallelFor(0, w, 1, [&](size_t lo, size_t hi) {
+                    ArenaScope thread_scope(scratchArena());
+                    std::pmr::vector<FieldElement> transformed(n1, &scratchArena());
+                    std::pmr::vector<FieldElement> column(maxRadix(), &scratchArena());
+                    for (size_t b = lo; b < hi; b++) {
+                        size_t j2 = j2_begin + b;
+                        nttRecursive(gathered.data() + b * n1, 1, transformed.data(),
+                                     n1, n2, 0, inverse, column.data());
+                        for (size_t k1 = 0; k1 < n1; k1++) {
+                            size_t idx = j2 * k1;
+                            if (inverse && idx != 0) idx = n - idx;
+                            gathered[b * n1 + k1] = twiddles->mul(transformed[k1], idx);
+                        }
+                    }
+                });
+
+                for (size_t k1 = 0; k1 < n1; k1++) {
+                    FieldElement* row = values.data() + k1 * n2 + j2_begin;
+                    for (size_t b = 0; b < w; b++) {
+                        row[b] = gathered[b * n1 + k1];
+                    }
+                }
+            }
+        }
+
+        // Pass 2: row transforms, written transposed into the result
+        size_t height = std::min(n1, std::max<size_t>(1, memory_budget / (n2 * elem)));
+        {
+            ArenaScope scope(scratchArena());
+            std::pmr::vector<FieldElement> rows(height * n2, &scratchArena());
+            FieldElement n_inv = FieldElement(n).inverse();
+            FieldElement g_n1 = g.power(n1);
+
+            for (size_t k1_begin = 0; k1_begin < n1; k1_begin += height) {
+                size_t h = std::min(height, n1 - k1_begin);
+                if (k1_begin + h < n1) {
+                    values.prefetch((k1_begin + h) * n2, std::min(height, n1 - k1_begin - h) * n2);
+                }
+
+                parallelFor(0, h, 1, [&](size_t lo, size_t hi) {
+                    ArenaScope thread_scope(scratchArena());
+                    std::pmr::vector<FieldElement> column(maxRadix(), &scratchArena());
+                    for (size_t b = lo; b < hi; b++) {
+                        nttRecursive(values.data() + (k1_begin + b) * n2, 1, rows.data() + b * n2,
+                                     n2, n1, split, inverse, column.data());
+                    }
+                });
+
+                // Inverse: c_k = X_k / N * g^-k with k = k1 + n1 * k2
+                FieldElement block_start = inverse ? n_inv * g.power(k1_begin) : FieldElement(1);
+                FieldElement col_factor(1);
+                for (size_t k2 = 0; k2 < n2; k2++) {
+                    FieldElement* dest = result.data() + k1_begin + n1 * k2;
+                    FieldElement factor = block_start * col_factor;
+                    for (size_t b = 0; b < h; b++) {
+                        if (inverse) {
+                            dest[b] = rows[b * n2 + k2] * factor;
+                            factor = factor * g;
+                        } else {
+                            dest[b] = rows[b * n2 + k2];
+                        }
+                    }
+                    col_factor = col_factor * g_n1;
+                }
+            }
+        }
+    }
+
+    // Plain (subgroup) transform of `values`, zero-padded to N. Only the
+    // first out_count outputs are produced; the rest of the result is zero.
+    std::vector<FieldElement> transform(const std::vector<FieldElement>& values, bool inverse,
+                                        size_t out_count = SIZE_MAX) const {
+        out_count = std::min(out_count, n);
+        size_t in_count = std::min(values.size(), n);
+
+        ArenaScope scope(scratchArena());
+        std::pmr::vector<FieldElement> input(n, FieldElement(0), &scratchArena());
+        for (size_t i = 0; i < in_count; i++) {
+            input[i] = values[i];
+        }
+
+        std::vector<FieldElement> output(n);
+        if (n >= four_step_threshold && radices.size() > 1) {
+            nttFourStep(input.data(), output.data(), inverse);
+        } else {
+            std::pmr::vector<FieldElement> column(maxRadix(), &scratchArena());
+            nttRecursive(input.data(), 1, output.data(), n, 1, 0, inverse, column.data(),
+                         in_count, out_count);
+        }
+        output.resize(out_count);
+        return output;
+    }
+
+public:
+    // Domains of at least this many points no longer fit in L2 as one
+    // vector and switch to the four-step NTT
+    static constexpr size_t DEFAULT_FOUR_STEP_THRESHOLD = size_t(1) << 16;
+
+    EvaluationDomain()
+        : kind(Kind::Arbitrary), n(0), shift(1), shift_pow_n(1), omega(1),
+          four_step_threshold(DEFAULT_FOUR_STEP_THRESHOLD) {}
+
+    // All subgroup sizes available in this field, in increasing order
+    static std::vector<uint64_t> availableSubgroupSizes() {
+        std::vector<uint64_t> sizes = {1};
+        std::vector<uint64_t> factors = factorGroupOrder(FieldElement::getPrime() - 1);
+        size_t i = 0;
+        while (i < factors.size()) {
+            uint64_t q = factors[i];
+            size_t multiplicity = 0;
+            while (i < factors.size() && factors[i] == q) {
+                multiplicity++;
+                i++;
+            }
+            size_t current = sizes.size();
+            uint64_t power = 1;
+            for (size_t e = 0; e < multiplicity; e++) {
+                power *= q;
+                for (size_t j = 0; j < current; j++) {
+                    sizes.push_back(sizes[j] * power);
+                }
+            }
+        }
+        std::sort(sizes.begin(), sizes.end());
+        return sizes;
+    }
+
+    // Estimated NTT cost for a subgroup of this size: each mixed-radix level
+    // costs about (radix) multiplications per element
+    static uint64_t transformCost(uint64_t size) {
+        uint64_t per_element = 0;
+        for (uint64_t radix : factorGroupOrder(size)) {
+            per_element += radix;
+        }
+        return size * std::max<uint64_t>(per_element, 1);
+    }
+
+    // Subgroup size N >= min_size with the cheapest NTT. Padding to the next
+    // size is often much less than a doubling here, but the very tightest
+    // size can carry a large radix (151, 331) that costs more than a
+    // slightly larger, smoother size.
+    static uint64_t subgroupSizeFor(size_t min_size) {
+        uint64_t best = 0;
+        uint64_t best_cost = UINT64_MAX;
+        for (uint64_t size : availableSubgroupSizes()) {
+            if (size < min_size) continue;
+            uint64_t cost = transformCost(size);
+            if (cost < best_cost) {
+                best = size;
+                best_cost = cost;
+            }
+        }
+        if (best == 0) {
+            throw std::runtime_error("No multiplicative subgroup of size >= " + std::to_string(min_size));
+        }
+        return best;
+    }
+
+    // Smallest subgroup size N >= min_size, regardless of NTT cost
+    static uint64_t tightestSubgroupSizeFor(size_t min_size) {
+        for (uint64_t size : availableSubgroupSizes()) {
+            if (size >= min_size) return size;
+        }
+        throw std::runtime_error("No multiplicative subgroup of size >= " + std::to_string(min_size));
+    }
+
+    // Multiplicative subgroup holding at least min_size points
+    static EvaluationDomain subgroup(size_t min_size) {
+        return coset(min_size, FieldElement(1));
+    }
+
+    // Coset g*H of a subgroup holding at least min_size points
+    static EvaluationDomain coset(size_t min_size, const FieldElement& offset) {
+        if (offset == FieldElement(0)) {
+            throw std::runtime_error("Coset offset must be non-zero");
+        }
+
+        return withSize(subgroupSizeFor(min_size), offset);
+    }
+
+    // Coset g*H of a subgroup of exactly `size` points (size must divide
+    // p - 1). Used to rebuild a domain whose size was chosen earlier.
+    static EvaluationDomain withSize(size_t size, const FieldElement& offset) {
+        if (offset == FieldElement(0)) {
+            throw std::runtime_error("Coset offset must be non-zero");
+        }
+
+        EvaluationDomain domain;
+        domain.n = size;
+        domain.kind = (offset == FieldElement(1)) ? Kind::Subgroup : Kind::Coset;
+        domain.shift = offset;
+        domain.shift_pow_n = offset.power(domain.n);
+        domain.twiddles = TwiddleTable::forSize(domain.n);
+        domain.omega = domain.twiddles->generator();
+        domain.radices = factorGroupOrder(domain.n);
+
+        domain.sparse_vanishing = SparsePolynomial::vanishing(domain.n, domain.shift_pow_n);
+        return domain;
+    }
+
+    // Fallback for any set of distinct points
+    static EvaluationDomain arbitrary(const std::vector<FieldElement>& x_values) {
+        EvaluationDomain domain;
+        domain.kind = Kind::Arbitrary;
+        domain.n = x_values.size();
+        domain.points = x_values;
+
+        // Z(x) = prod (x - x_i)
+        domain.vanishing = Polynomial({FieldElement(1)});
+        for (const auto& x : x_values) {
+            domain.vanishing *= Polynomial({FieldElement(0) - x, FieldElement(1)});
+        }
+
+        // w_i = 1 / prod_{j != i} (x_i - x_j)
+        domain.weights.assign(domain.n, FieldElement(1));
+        for (size_t i = 0; i < domain.n; i++) {
+            for (size_t j = 0; j < domain.n; j++) {
+                if (i == j) continue;
+                FieldElement diff = x_values[i] - x_values[j];
+                if (diff == FieldElement(0)) {
+                    throw std::runtime_error("Evaluation points must be distinct");
+                }
+                domain.weights[i] = domain.weights[i] * diff;
+            }
+        }
+        FieldElement::batchInvert(domain.weights);
+        return domain;
+    }
+
+    // The original layout: constraint i is placed at x = i + 1
+    static EvaluationDomain consecutive(size_t m) {
+        std::vector<FieldElement> x_values;
+        for (size_t i = 0; i < m; i++) {
+            x_values.push_back(FieldElement(i + 1));
+        }
+        return arbitrary(x_values);
+    }
+
+    Kind getKind() const { return kind; }
+    size_t size() const { return n; }
+    bool isMultiplicative() const { return kind != Kind::Arbitrary; }
+    FieldElement generator() const { return omega; }
+    FieldElement offset() const { return shift; }
+    const std::vector<FieldElement>& getTwiddles() const {
+        static const std::vector<FieldElement> none;
+        return twiddles ? twiddles->getRoots() : none;
+    }
+    std::shared_ptr<const TwiddleTable> twiddleTable() const { return twiddles; }
+
+    // Z(x) in coefficient form; built on demand for subgroups and cosets
+    Polynomial vanishingPolynomial() const {
+        return kind == Kind::Arbitrary ? vanishing : sparse_vanishing.toDense();
+    }
+
+    // Tune the four-step cut-over to the host's cache size
+    void setFourStepThreshold(size_t min_size) { four_step_threshold = min_size; }
+
+    // i-th point of the domain (g * w^i for subgroups and cosets)
+    FieldElement element(size_t i) const {
+        if (kind == Kind::Arbitrary) return points[i];
+        return shift * twiddles->getRoots()[i % n];
+    }
+
+    // Z(r): O(log N) for subgroups and cosets, O(N) otherwise
+    FieldElement evaluateVanishing(const FieldElement& r) const {
+        if (kind != Kind::Arbitrary) {
+            return r.power(n) - shift_pow_n;
+        }
+        FieldElement result(1);
+        for (const auto& x : points) {
+            result = result * (r - x);
+        }
+        return result;
+    }
+
+    // L_0(r), ..., L_{N-1}(r) in O(N) field operations plus one inversion.
+    // Subgroup/coset: L_i(r) = Z(r) * x_i / (N * g^N * (r - x_i))
+    // Arbitrary:      L_i(r) = Z(r) * w_i / (r - x_i)
+    std::vector<FieldElement> lagrangeCoefficients(const FieldElement& r) const {
+        std::vector<FieldElement> result(n, FieldElement(0));
+        FieldElement z = evaluateVanishing(r);
+
+        if (z == FieldElement(0)) {
+            // r is a domain point: the basis is the unit vector there
+            for (size_t i = 0; i < n; i++) {
+                if (element(i) == r) {
+                    result[i] = FieldElement(1);
+                    break;
+                }
+            }
+            return result;
+        }
+
+        // 1 / (r - x_i), computed in the output buffer
+        for (size_t i = 0; i < n; i++) {
+            result[i] = r - element(i);
+        }
+        FieldElement::batchInvert(result);
+
+        if (kind == Kind::Arbitrary) {
+            for (size_t i = 0; i < n; i++) {
+                result[i] = z * weights[i] * result[i];
+            }
+        } else {
+            FieldElement scale = z / (FieldElement(n) * shift_pow_n);
+            for (size_t i = 0; i < n; i++) {
+                result[i] = scale * element(i) * result[i];
+            }
+        }
+        return result;
+    }
+
+    // Single basis polynomial L_i(r)
+    FieldElement lagrangeAt(size_t i, const FieldElement& r) const {
+        FieldElement x_i = element(i);
+        FieldElement z = evaluateVanishing(r);
+        if (z == FieldElement(0)) {
+            return (r == x_i) ? FieldElement(1) : FieldElement(0);
+        }
+        if (kind == Kind::Arbitrary) {
+            return z * weights[i] / (r - x_i);
+        }
+        return z * x_i / (FieldElement(n) * shift_pow_n * (r - x_i));
+    }
+
+    // Evaluate the polynomial given by its values on the domain at r, in O(N)
+    FieldElement evaluateFromEvaluations(const std::vector<FieldElement>& evals,
+                                         const FieldElement& r) const {
+        std::vector<FieldElement> basis = lagrangeCoefficients(r);
+        FieldElement result(0);
+        for (size_t i = 0; i < evals.size() && i < n; i++) {
+            result = result + evals[i] * basis[i];
+        }
+        return result;
+    }
+
+    // Coefficients -> evaluations on the domain
+    std::vector<FieldElement> fft(const std::vector<FieldElement>& coeffs) const {
+        if (kind == Kind::Arbitrary) {
+            Polynomial p(coeffs);
+            std::vector<FieldElement> evals(n);
+            for (size_t i = 0; i < n; i++) {
+                evals[i] = p.evaluate(points[i]);
+            }
+            return evals;
+        }
+        if (coeffs.size() > n) {
+            throw std::runtime_error("Polynomial degree exceeds domain size");
+        }
+
+        // Coset: f(g * w^i) is the plain transform of c_k * g^k
+        std::vector<FieldElement> scaled(coeffs);
+        FieldElement g_pow(1);
+        for (auto& c : scaled) {
+            c = c * g_pow;
+            g_pow = g_pow * shift;
+        }
+        return transform(scaled, false);
+    }
+
+    // Evaluations on the domain -> coefficients (degree < N)
+    std::vector<FieldElement> ifft(const std::vector<FieldElement>& evals) const {
+        if (kind == Kind::Arbitrary) {
+            return interpolate(evals).coefficients;
+        }
+
+        std::vector<FieldElement> coeffs = transform(evals, true);
+        FieldElement n_inv = FieldElement(n).inverse();
+        FieldElement g_inv = shift.inverse();
+        FieldElement scale = n_inv;
+        for (auto& c : coeffs) {
+            c = c * scale;
+            scale = scale * g_inv;
+        }
+        return coeffs;
+    }
+
+    // Coefficients -> evaluations for vectors that live on disk. `values`
+    // is used as working space and left clobbered; the evaluations are
+    // written to `result`. Scratch stays within about memory_budget bytes.
+    void fftOutOfCore(MappedVector<FieldElement>& values, MappedVector<FieldElement>& result,
+                      size_t memory_budget) const {
+        transformOutOfCore(values, result, false, memory_budget);
+    }
+
+    // Evaluations -> coefficients for vectors that live on disk
+    void ifftOutOfCore(MappedVector<FieldElement>& values, MappedVector<FieldElement>& result,
+                       size_t memory_budget) const {
+        transformOutOfCore(values, result, true, memory_budget);
+    }
+
+    // First num_outputs evaluations f(element(0)), ..., f(element(num_outputs - 1)).
+    // Zero padding past coeffs.size() and the unused outputs are pruned from
+    // the transform.
+    std::vector<FieldElement> fftTruncated(const std::vector<FieldElement>& coeffs,
+                                           size_t num_outputs) const {
+        if (kind == Kind::Arbitrary || coeffs.size() > n) {
+            std::vector<FieldElement> evals = fft(coeffs);
+            evals.resize(std::min(num_outputs, evals.size()));
+            return evals;
+        }
+
+        std::vector<FieldElement> scaled(coeffs);
+        FieldElement g_pow(1);
+        for (auto& c : scaled) {
+            c = c * g_pow;
+            g_pow = g_pow * shift;
+        }
+        return transform(scaled, false, num_outputs);
+    }
+
+    // Lowest num_coeffs coefficients of the interpolant; use when the
+    // polynomial is known to have degree < num_coeffs
+    std::vector<FieldElement> ifftTruncated(const std::vector<FieldElement>& evals,
+                                            size_t num_coeffs) const {
+        if (kind == Kind::Arbitrary) {
+            std::vector<FieldElement> coeffs = ifft(evals);
+            coeffs.resize(std::min(num_coeffs, coeffs.size()));
+            return coeffs;
+        }
+
+        std::vector<FieldElement> coeffs = transform(evals, true, num_coeffs);
+        FieldElement g_inv = shift.inverse();
+        FieldElement scale = FieldElement(n).inverse();
+        for (auto& c : coeffs) {
+            c = c * scale;
+            scale = scale * g_inv;
+        }
+        return coeffs;
+    }
+
+    // Product of two polynomials. Short operands use schoolbook; otherwise
+    // the product goes through the radix-2 transform over the complex
+    // extension CM31, which needs one forward and one inverse transform and
+    // beats the mixed-radix NTT at every size.
+    static Polynomial multiply(const Polynomial& a, const Polynomial& b) {
+        if (a.coefficients.empty() || b.coefficients.empty()) {
+            return Polynomial();
+        }
+        if (std::min(a.coefficients.size(), b.coefficients.size()) < 16) {
+            return a * b;
+        }
+        return CM31Transform::multiply(a, b);
+    }
+
+    // Product through the NTT on the cheapest subgroup that holds it: both
+    // forward transforms skip the zero padding and the inverse stops at the
+    // product's length
+    static Polynomial multiplyInSubgroup(const Polynomial& a, const Polynomial& b) {
+        if (a.coefficients.empty() || b.coefficients.empty()) {
+            return Polynomial();
+        }
+        size_t product_size = a.coefficients.size() + b.coefficients.size() - 1;
+
+        EvaluationDomain domain = subgroup(product_size);
+        std::vector<FieldElement> ea = domain.fft(a.coefficients);
+        std::vector<FieldElement> eb = domain.fft(b.coefficients);
+        for (size_t i = 0; i < ea.size(); i++) {
+            ea[i] = ea[i] * eb[i];
+        }
+        return Polynomial(domain.ifftTruncated(ea, product_size));
+    }
+
+    // Interpolate the polynomial of degree < N taking evals[i] at element(i).
+    // Missing trailing values are treated as zero.
+    Polynomial interpolate(const std::vector<FieldElement>& evals) const {
+        if (evals.size() > n) {
+            throw std::runtime_error("More values than domain points");
+        }
+        if (kind != Kind::Arbitrary) {
+            return Polynomial(ifft(evals));
+        }
+
+        // sum_i y_i * w_i * Z(x) / (x - x_i); only non-zero values contribute
+        std::vector<FieldElement> result(n > 0 ? n : 1, FieldElement(0));
+        const std::vector<FieldElement>& z = vanishing.coefficients;
+        for (size_t i = 0; i < evals.size(); i++) {
+            if (evals[i] == FieldElement(0)) continue;
+            FieldElement scale = evals[i] * weights[i];
+
+            // Synthetic division of Z(x) by (x - x_i)
+            FieldElement carry(0);
+            for (size_t k = n; k-- > 0;) {
+                carry = z[k + 1] + carry * points[i];
+                result[k] = result[k] + carry * scale;
+            }
+        }
+        return Polynomial(result);
+    }
+
+    // Z(x) as its non-zero terms: x^N - g^N for subgroups and cosets
+    SparsePolynomial sparseVanishing() const {
+        if (kind == Kind::Arbitrary) {
+            return SparsePolynomial::fromDense(vanishing);
+        }
+        return sparse_vanishing;
+    }
+
+    // Quotient of p(x) by Z(x); linear time for subgroups and cosets, whose
+    // Z has two terms
+    Polynomial divideByVanishing(const Polynomial& p, Polynomial& remainder) const {
+        if (kind == Kind::Arbitrary) {
+            return p.divide(vanishing, remainder);
+        }
+        return SparsePolynomial::divide(p, sparse_vanishing, remainder);
+    }
+
+    void print() const {
+        switch (kind) {
+            case Kind::Subgroup:
+                std::cout << "multiplicative subgroup of size " << n
+                          << " (generator " << omega << ")";
+                break;
+            case Kind::Coset:
+                std::cout << "coset " << shift << "·H of size " << n
+                          << " (generator " << omega << ")";
+                break;
+            case Kind::Arbitrary:
+                std::cout << "arbitrary points (" << n << ")";
+                break;
+        }
+    }
+};
+
+#endif // DOMAIN_H
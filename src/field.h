@@ -4,6 +4,9 @@
 #include <iostream>
 #include <string>
 #include <cstdint>
+#include <stdexcept>
+#include <vector>
+#include "arena.h"
 
 // Simplified field arithmetic over a small prime (for educational purposes)
 // Using a 64-bit prime for simplicity
@@ -104,6 +107,58 @@ public:
     }
     
     static uint64_t getPrime() { return SMALL_PRIME; }
+    
+    // Partial reduction of a product of two reduced values (< 2^62) modulo
+    // 2^31 - 1. The result is congruent to x and below 2^32, so callers can
+    // sum many products in 64 bits and reduce once at the end.
+    static uint64_t foldProduct(uint64_t x) { return (x & SMALL_PRIME) + (x >> 31); }
+    
+    // Shoup companion of a fixed multiplier w: floor(w * 2^32 / p). With it,
+    // a * w mod p needs two multiplications and no division.
+    static uint64_t shoupPrecompute(const FieldElement& w) {
+        return (w.value << 32) / SMALL_PRIME;
+    }
+    
+    // a * w mod p, given w_shoup = shoupPrecompute(w)
+    static FieldElement mulShoup(const FieldElement& a, const FieldElement& w, uint64_t w_shoup) {
+        uint64_t q = (a.value * w_shoup) >> 32;
+        uint64_t r = a.value * w.value - q * SMALL_PRIME; // in [0, 2p)
+        FieldElement result;
+        result.value = (r >= SMALL_PRIME) ? r - SMALL_PRIME : r;
+        return result;
+    }
+    
+    // 7 generates the full multiplicative group of F_p
+    // (p - 1 = 2 * 3^2 * 7 * 11 * 31 * 151 * 331)
+    static FieldElement multiplicativeGenerator() { return FieldElement(7); }
+    
+    // Primitive n-th root of unity; exists only when n divides p - 1
+    static FieldElement rootOfUnity(uint64_t n) {
+        if (n == 0 || (SMALL_PRIME - 1) % n != 0) {
+            throw std::runtime_error("No root of unity of order " + std::to_string(n));
+        }
+        return multiplicativeGenerator().power((SMALL_PRIME - 1) / n);
+    }
+    
+    // Invert every non-zero element in place with a single inversion
+    // (Montgomery's trick). Zero entries are left untouched.
+    static void batchInvert(std::vector<FieldElement>& values) {
+        ArenaScope scope(scratchArena());
+        std::pmr::vector<FieldElement> prefix(values.size(), &scratchArena());
+        FieldElement acc(1);
+        for (size_t i = 0; i < values.size(); i++) {
+            prefix[i] = acc;
+            if (values[i] != FieldElement(0)) acc = acc * values[i];
+        }
+        
+        FieldElement inv = acc.inverse();
+        for (size_t i = values.size(); i-- > 0;) {
+            if (values[i] == FieldElement(0)) continue;
+            FieldElement original = values[i];
+            values[i] = inv * prefix[i];
+            inv = inv * original;
+        }
+    }
 };
 
 #endif // FIELD_H
@@ -0,0 +1,70 @@
+#ifndef FIXED_BASE_H
+#define FIXED_BASE_H
+
+#include "field.h"
+#include "parallel.h"
+#include <vector>
+#include <cstdint>
+
+// Fixed-base scalar multiplication: k * G for many scalars k and one G.
+//
+// The table holds d * 2^(c w) * G for every c-bit window w and digit
+// d = 1 .. 2^c - 1. A product is then one table lookup and one addition
+// per window (4 for 31-bit scalars with c = 8) and no doublings. Works for
+// any group type with a default identity and operator+, e.g. the groups
+// of a pairing backend.
+template <typename Point>
+class FixedBaseTable {
+private:
+    unsigned window_bits;
+    size_t windows;
+    size_t digits;              // 2^c - 1 entries per window
+    std::vector<Point> table;   // table[w * digits + d - 1] = d * 2^(c w) * G
+
+public:
+    explicit FixedBaseTable(const Point& base, unsigned bits = 8, unsigned scalar_bits = 31)
+        : window_bits(bits), windows((scalar_bits + bits - 1) / bits),
+          digits((size_t(1) << bits) - 1), table(windows * digits) {
+        Point window_base = base;
+        for (size_t w = 0; w < windows; w++) {
+            Point multiple = window_base;
+            for (size_t d = 0; d < digits; d++) {
+                table[w * digits + d] = multiple;
+                multiple = multiple + window_base;
+            }
+            for (unsigned b = 0; b < window_bits; b++) {
+                window_base = window_base + window_base;
+            }
+        }
+    }
+
+    Point multiply(uint64_t scalar) const {
+        Point result;
+        uint64_t mask = digits;
+        for (size_t w = 0; w < windows && scalar != 0; w++) {
+            uint64_t digit = scalar & mask;
+            if (digit != 0) {
+                result = result + table[w * digits + digit - 1];
+            }
+            scalar >>= window_bits;
+        }
+        return result;
+    }
+
+    // out[i] = scalars[i] * G
+    void multiplyBatch(const FieldElement* scalars, size_t count, Point* out) const {
+        parallelFor(0, count, 1024, [&](size_t lo, size_t hi) {
+            for (size_t i = lo; i < hi; i++) {
+                out[i] = multiply(scalars[i].getValue());
+            }
+        });
+    }
+
+    std::vector<Point> multiplyBatch(const std::vector<FieldElement>& scalars) const {
+        std::vector<Point> out(scalars.size());
+        multiplyBatch(scalars.data(), scalars.size(), out.data());
+        return out;
+    }
+};
+
+#endif // FIXED_BASE_H
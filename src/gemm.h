@@ -0,0 +1,126 @@
+#ifndef GEMM_H
+#define GEMM_H
+
+#include "field.h"
+#include "parallel.h"
+#include "arena.h"
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <cstdint>
+
+// Dense row-major matrix over the field
+class FieldMatrix {
+public:
+    size_t rows;
+    size_t cols;
+    std::vector<FieldElement> data;
+
+    FieldMatrix() : rows(0), cols(0) {}
+    FieldMatrix(size_t r, size_t c) : rows(r), cols(c), data(r * c, FieldElement(0)) {}
+
+    FieldElement& at(size_t r, size_t c) { return data[r * cols + c]; }
+    const FieldElement& at(size_t r, size_t c) const { return data[r * cols + c]; }
+    FieldElement* row(size_t r) { return data.data() + r * cols; }
+    const FieldElement* row(size_t r) const { return data.data() + r * cols; }
+
+    // Matrix whose rows are the given vectors, each zero-padded to `width`
+    static FieldMatrix fromRows(const std::vector<std::vector<FieldElement>>& source, size_t width) {
+        FieldMatrix m(source.size(), width);
+        for (size_t r = 0; r < source.size(); r++) {
+            std::copy(source[r].begin(), source[r].begin() + std::min(width, source[r].size()), m.row(r));
+        }
+        return m;
+    }
+
+    FieldMatrix transpose() const {
+        FieldMatrix t(cols, rows);
+        for (size_t r = 0; r < rows; r++) {
+            for (size_t c = 0; c < cols; c++) {
+                t.at(c, r) = at(r, c);
+            }
+        }
+        return t;
+    }
+};
+
+// Tile sizes of the blocked product: a GEMM_K_BLOCK x GEMM_N_BLOCK tile of
+// B, packed to 32-bit words (64 KB), stays in L2 while GEMM_M_BLOCK rows of A stream over it, and
+// the row accumulators (GEMM_M_BLOCK x GEMM_N_BLOCK x 8 bytes) stay in L1/L2.
+constexpr size_t GEMM_M_BLOCK = 16;
+constexpr size_t GEMM_N_BLOCK = 256;
+constexpr size_t GEMM_K_BLOCK = 64;
+
+// C = A * B with lazy reduction.
+//
+// Every product a*b < 2^62 is folded once to below 2^32 and summed into a
+// 64-bit accumulator; the accumulator is reduced once per output, after the
+// whole inner dimension (up to 2^32 terms). The innermost loop is
+//   acc[j] += fold(a * B[k][j])
+// over a contiguous row of B: 32x32->64 multiplies with no branches, which
+// the compiler vectorises. Output tiles are independent and are spread over
+// the thread pool.
+inline void gemm(const FieldMatrix& A, const FieldMatrix& B, FieldMatrix& C) {
+    if (A.cols != B.rows) {
+        throw std::runtime_error("Matrix dimensions do not match for multiplication");
+    }
+    if (C.rows != A.rows || C.cols != B.cols) {
+        C = FieldMatrix(A.rows, B.cols);
+    }
+
+    size_t m_tiles = (A.rows + GEMM_M_BLOCK - 1) / GEMM_M_BLOCK;
+    size_t n_tiles = (B.cols + GEMM_N_BLOCK - 1) / GEMM_N_BLOCK;
+    size_t inner = A.cols;
+
+    parallelFor(0, m_tiles * n_tiles, 1, [&](size_t lo, size_t hi) {
+        ArenaScope scope(scratchArena());
+        std::pmr::vector<uint64_t> acc(GEMM_M_BLOCK * GEMM_N_BLOCK, &scratchArena());
+        std::pmr::vector<uint32_t> b_tile(GEMM_K_BLOCK * GEMM_N_BLOCK, &scratchArena());
+
+        for (size_t tile = lo; tile < hi; tile++) {
+            size_t i0 = (tile / n_tiles) * GEMM_M_BLOCK;
+            size_t j0 = (tile % n_tiles) * GEMM_N_BLOCK;
+            size_t i_end = std::min(i0 + GEMM_M_BLOCK, A.rows);
+            size_t width = std::min(GEMM_N_BLOCK, B.cols - j0);
+            std::fill(acc.begin(), acc.end(), 0);
+
+            for (size_t k0 = 0; k0 < inner; k0 += GEMM_K_BLOCK) {
+                size_t k_end = std::min(k0 + GEMM_K_BLOCK, inner);
+
+                // Pack the B tile as 32-bit words once; every row of A reuses it
+                for (size_t k = k0; k < k_end; k++) {
+                    const FieldElement* b_row = B.row(k) + j0;
+                    uint32_t* packed = b_tile.data() + (k - k0) * GEMM_N_BLOCK;
+                    for (size_t j = 0; j < width; j++) {
+                        packed[j] = static_cast<uint32_t>(b_row[j].getValue());
+                    }
+                    std::fill(packed + width, packed + GEMM_N_BLOCK, 0);
+                }
+
+                for (size_t i = i0; i < i_end; i++) {
+                    const FieldElement* a_row = A.row(i);
+                    uint64_t* acc_row = acc.data() + (i - i0) * GEMM_N_BLOCK;
+                    for (size_t k = k0; k < k_end; k++) {
+                        uint32_t a = static_cast<uint32_t>(a_row[k].getValue());
+                        if (a == 0) continue;
+                        const uint32_t* packed = b_tile.data() + (k - k0) * GEMM_N_BLOCK;
+                        // Full-width tile (zero-padded): a fixed trip count vectorises at -O2
+                        for (size_t j = 0; j < GEMM_N_BLOCK; j++) {
+                            acc_row[j] += FieldElement::foldProduct(uint64_t(a) * packed[j]);
+                        }
+                    }
+                }
+            }
+
+            for (size_t i = i0; i < i_end; i++) {
+                const uint64_t* acc_row = acc.data() + (i - i0) * GEMM_N_BLOCK;
+                FieldElement* c_row = C.row(i) + j0;
+                for (size_t j = 0; j < width; j++) {
+                    c_row[j] = FieldElement(acc_row[j]);
+                }
+            }
+        }
+    });
+}
+
+#endif // GEMM_H
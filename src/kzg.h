@@ -0,0 +1,378 @@
+#ifndef KZG_H
+#define KZG_H
+
+#include "field.h"
+#include "polynomial.h"
+#include "sparse_polynomial.h"
+#include "msm.h"
+#include "pairing.h"
+#include "mapped_file.h"
+#include <vector>
+#include <string>
+#include <random>
+#include <utility>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <stdexcept>
+
+// Structured reference string: [tau^i]_1 for i <= max degree and the first
+// few [tau^i]_2 (two suffice for single-point openings; opening at k points
+// at once needs k + 1).
+template <typename Pairing>
+struct KZGSetup {
+    std::vector<typename Pairing::G1> g1_powers;
+    std::vector<typename Pairing::G2> g2_powers;
+
+    size_t maxDegree() const { return g1_powers.empty() ? 0 : g1_powers.size() - 1; }
+};
+
+// Header of a serialised SRS; the element bytes that follow are covered
+// by `checksum`
+struct KZGSetupHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t g1_count;
+    uint64_t g2_count;
+    uint32_t g1_bytes;          // size of one serialised G1 element
+    uint32_t g2_bytes;          // size of one serialised G2 element
+    uint64_t checksum;          // checksum64 of the element bytes
+};
+
+// Proof that the committed polynomial takes `value` at `point`
+template <typename Pairing>
+struct KZGOpening {
+    FieldElement point;
+    FieldElement value;
+    typename Pairing::G1 witness;   // [q(tau)]_1, q = (f - value) / (x - point)
+};
+
+// One proof for several polynomials at the same point
+template <typename Pairing>
+struct KZGBatchOpening {
+    FieldElement point;
+    std::vector<FieldElement> values;
+    typename Pairing::G1 witness;   // quotient of sum_i gamma^i f_i
+};
+
+// One proof for one polynomial at several points
+template <typename Pairing>
+struct KZGMultiOpening {
+    std::vector<FieldElement> points;
+    std::vector<FieldElement> values;
+    typename Pairing::G1 witness;   // [q(tau)]_1, q = (f - I) / Z_S
+};
+
+// KZG polynomial commitments.
+//
+//   commit(f)     C = [f(tau)]_1 = sum_i f_i [tau^i]_1   (one MSM)
+//   open(f, z)    pi = [q(tau)]_1 with q = (f - f(z)) / (x - z)
+//   verify        e(C - [y]_1 + z pi, [1]_2) == e(pi, [tau]_2)
+//
+// Generic over the pairing backend (see pairing.h). With ToyPairing the
+// scheme runs and checks correctly but is not hiding or binding.
+template <typename Pairing = ToyPairing>
+class KZG {
+public:
+    using G1 = typename Pairing::G1;
+    using G2 = typename Pairing::G2;
+    using Setup = KZGSetup<Pairing>;
+    using Opening = KZGOpening<Pairing>;
+    using BatchOpening = KZGBatchOpening<Pairing>;
+    using MultiOpening = KZGMultiOpening<Pairing>;
+
+    static constexpr uint32_t MAGIC = 0x31475A4B; // "KZG1"
+    static constexpr uint32_t VERSION = 1;
+
+private:
+    Setup srs;
+
+    static FieldElement randomChallenge() {
+        static thread_local std::mt19937_64 gen(std::random_device{}());
+        std::uniform_int_distribution<uint64_t> dis(1, FieldElement::getPrime() - 1);
+        return FieldElement(dis(gen));
+    }
+
+    // 1, gamma, gamma^2, ...
+    static std::vector<FieldElement> powersOf(const FieldElement& gamma, size_t count) {
+        std::vector<FieldElement> powers(count);
+        FieldElement power(1);
+        for (size_t i = 0; i < count; i++) {
+            powers[i] = power;
+            power = power * gamma;
+        }
+        return powers;
+    }
+
+    // Z_S(x) = prod (x - s_i)
+    static Polynomial vanishingOn(const std::vector<FieldElement>& points) {
+        std::vector<FieldElement> coeffs(points.size() + 1, FieldElement(0));
+        coeffs[0] = FieldElement(1);
+        for (size_t i = 0; i < points.size(); i++) {
+            for (size_t k = i + 1; k > 0; k--) {
+                coeffs[k] = coeffs[k - 1] - points[i] * coeffs[k];
+            }
+            coeffs[0] = FieldElement(0) - points[i] * coeffs[0];
+        }
+        return Polynomial(std::move(coeffs));
+    }
+
+    // [q(tau)]_1 for the quotient of f by (x - z); the remainder is f(z)
+    G1 quotientCommitment(const Polynomial& f, const FieldElement& z, FieldElement& value) const {
+        Polynomial remainder;
+        Polynomial quotient = SparsePolynomial::divide(f, SparsePolynomial::vanishing(1, z), remainder);
+        value = remainder.coefficients[0];
+        return commit(quotient);
+    }
+
+public:
+    KZG() {}
+    explicit KZG(Setup setup) : srs(std::move(setup)) {}
+
+    const Setup& setup() const { return srs; }
+    size_t maxDegree() const { return srs.maxDegree(); }
+
+    // Trusted setup from a known tau (toxic waste: real deployments take the
+    // SRS from a ceremony through loadSetup)
+    static Setup generateSetup(size_t max_degree, const FieldElement& tau, size_t g2_count = 2) {
+        if (g2_count < 2) {
+            throw std::runtime_error("KZG setup needs at least [1]_2 and [tau]_2");
+        }
+        Setup s;
+        std::vector<FieldElement> powers = powersOf(tau, std::max(max_degree + 1, g2_count));
+        s.g1_powers.resize(max_degree + 1);
+        s.g2_powers.resize(g2_count);
+        parallelFor(0, max_degree + 1, 1024, [&](size_t lo, size_t hi) {
+            for (size_t i = lo; i < hi; i++) {
+                s.g1_powers[i] = Pairing::g1() * powers[i];
+            }
+        });
+        for (size_t i = 0; i < g2_count; i++) {
+            s.g2_powers[i] = Pairing::g2() * powers[i];
+        }
+        return s;
+    }
+
+    static KZG fromRandomSetup(size_t max_degree, size_t g2_count = 2) {
+        return KZG(generateSetup(max_degree, randomChallenge(), g2_count));
+    }
+
+    // Write the SRS under a unique temporary name and rename it into place
+    static void saveSetup(const Setup& s, const std::string& path) {
+        size_t payload = s.g1_powers.size() * G1::BYTES + s.g2_powers.size() * G2::BYTES;
+        std::string staging = path + ".tmp" + std::to_string(std::random_device()());
+        {
+            MappedFile file = MappedFile::create(staging, sizeof(KZGSetupHeader) + payload);
+            unsigned char* base = static_cast<unsigned char*>(file.data());
+            unsigned char* out = base + sizeof(KZGSetupHeader);
+            for (const G1& p : s.g1_powers) {
+                p.toBytes(out);
+                out += G1::BYTES;
+            }
+            for (const G2& p : s.g2_powers) {
+                p.toBytes(out);
+                out += G2::BYTES;
+            }
+
+            KZGSetupHeader header{};
+            header.magic = MAGIC;
+            header.version = VERSION;
+            header.g1_count = s.g1_powers.size();
+            header.g2_count = s.g2_powers.size();
+            header.g1_bytes = static_cast<uint32_t>(G1::BYTES);
+            header.g2_bytes = static_cast<uint32_t>(G2::BYTES);
+            header.checksum = checksum64(base + sizeof(KZGSetupHeader), payload);
+            std::memcpy(base, &header, sizeof(header));
+            file.flush();
+        }
+
+        // rename replaces an old setup atomically; Windows needs it gone first
+#ifdef _WIN32
+        std::remove(path.c_str());
+#endif
+        if (std::rename(staging.c_str(), path.c_str()) != 0) {
+            std::remove(staging.c_str());
+            throw std::runtime_error("Cannot publish KZG setup " + path);
+        }
+    }
+
+    // Load an SRS, optionally keeping only the powers up to max_degree
+    static Setup loadSetup(const std::string& path, size_t max_degree = SIZE_MAX) {
+        MappedFile file = MappedFile::open(path);
+        if (file.size() < sizeof(KZGSetupHeader)) {
+            throw std::runtime_error("KZG setup is truncated");
+        }
+        KZGSetupHeader header;
+        std::memcpy(&header, file.data(), sizeof(header));
+        if (header.magic != MAGIC || header.version != VERSION) {
+            throw std::runtime_error("Not a KZG setup (or an unsupported version)");
+        }
+        if (header.g1_bytes != G1::BYTES || header.g2_bytes != G2::BYTES) {
+            throw std::runtime_error("KZG setup was written for a different curve");
+        }
+        if (header.g1_count == 0 || header.g2_count < 2 ||
+            header.g1_count > (file.size() - sizeof(header)) / G1::BYTES) {
+            throw std::runtime_error("KZG setup is truncated");
+        }
+        size_t payload = header.g1_count * G1::BYTES + header.g2_count * G2::BYTES;
+        if (payload != file.size() - sizeof(header)) {
+            throw std::runtime_error("KZG setup is truncated");
+        }
+
+        const unsigned char* in = static_cast<const unsigned char*>(file.data()) + sizeof(header);
+        file.prefetch(sizeof(header), payload);
+        if (checksum64(in, payload) != header.checksum) {
+            throw std::runtime_error("KZG setup failed its checksum");
+        }
+
+        Setup s;
+        size_t g1_keep = std::min<uint64_t>(header.g1_count, max_degree == SIZE_MAX ? header.g1_count : max_degree + 1);
+        s.g1_powers.resize(g1_keep);
+        for (size_t i = 0; i < g1_keep; i++) {
+            s.g1_powers[i] = G1::fromBytes(in + i * G1::BYTES);
+        }
+        in += header.g1_count * G1::BYTES;
+        s.g2_powers.resize(header.g2_count);
+        for (size_t i = 0; i < header.g2_count; i++) {
+            s.g2_powers[i] = G2::fromBytes(in + i * G2::BYTES);
+        }
+        return s;
+    }
+
+    // C = sum_i f_i [tau^i]_1 through the MSM engine
+    G1 commit(const Polynomial& f) const {
+        int degree = f.degree();
+        if (degree < 0) return G1();
+        if (static_cast<size_t>(degree) >= srs.g1_powers.size()) {
+            throw std::runtime_error("Polynomial degree exceeds the KZG setup");
+        }
+        std::vector<FieldElement> scalars(f.coefficients.begin(), f.coefficients.begin() + degree + 1);
+        return msm(srs.g1_powers, scalars);
+    }
+
+    std::vector<G1> commitAll(const std::vector<Polynomial>& polys) const {
+        std::vector<G1> commitments;
+        commitments.reserve(polys.size());
+        for (const Polynomial& f : polys) {
+            commitments.push_back(commit(f));
+        }
+        return commitments;
+    }
+
+    Opening open(const Polynomial& f, const FieldElement& z) const {
+        Opening opening;
+        opening.point = z;
+        opening.witness = quotientCommitment(f, z, opening.value);
+        return opening;
+    }
+
+    // e(C - [y]_1 + z pi, [1]_2) * e(-pi, [tau]_2) == 1
+    bool verify(const G1& commitment, const Opening& opening) const {
+        G1 lhs = commitment - Pairing::g1() * opening.value + opening.witness * opening.point;
+        return Pairing::check({{lhs, srs.g2_powers[0]},
+                               {G1() - opening.witness, srs.g2_powers[1]}});
+    }
+
+    // Several polynomials at one point: the quotients are linear, so a single
+    // division of f = sum_i gamma^i f_i gives one witness for all of them
+    BatchOpening openBatch(const std::vector<Polynomial>& polys, const FieldElement& z,
+                           const FieldElement& gamma) const {
+        BatchOpening opening;
+        opening.point = z;
+        opening.values.reserve(polys.size());
+        for (const Polynomial& f : polys) {
+            opening.values.push_back(f.evaluate(z));
+        }
+        Polynomial combined;
+        Polynomial::linearCombination(polys, powersOf(gamma, polys.size()), combined);
+        FieldElement combined_value;
+        opening.witness = quotientCommitment(combined, z, combined_value);
+        return opening;
+    }
+
+    bool verifyBatch(const std::vector<G1>& commitments, const BatchOpening& opening,
+                     const FieldElement& gamma) const {
+        if (commitments.size() != opening.values.size()) {
+            throw std::runtime_error("Batch opening does not match the commitments");
+        }
+        std::vector<FieldElement> gammas = powersOf(gamma, commitments.size());
+        Opening combined;
+        combined.point = opening.point;
+        combined.value = FieldElement(0);
+        for (size_t i = 0; i < gammas.size(); i++) {
+            combined.value = combined.value + gammas[i] * opening.values[i];
+        }
+        combined.witness = opening.witness;
+        return verify(msm(commitments, gammas), combined);
+    }
+
+    // One polynomial at several points: q = (f - I) / Z_S where I interpolates
+    // the claimed values on S. Needs [tau^i]_2 up to |S|.
+    MultiOpening openMulti(const Polynomial& f, const std::vector<FieldElement>& points) const {
+        MultiOpening opening;
+        opening.points = points;
+        opening.values = f.evaluateMany(points);
+        Polynomial interpolant = LagrangeInterpolation::interpolate(points, opening.values);
+        Polynomial remainder;
+        Polynomial quotient = (f - interpolant).divide(vanishingOn(points), remainder);
+        if (remainder.degree() >= 0) {
+            throw std::runtime_error("KZG multi-point opening has a non-zero remainder");
+        }
+        opening.witness = commit(quotient);
+        return opening;
+    }
+
+    // e(C - [I(tau)]_1, [1]_2) == e(pi, [Z_S(tau)]_2)
+    bool verifyMulti(const G1& commitment, const MultiOpening& opening) const {
+        if (opening.points.size() != opening.values.size()) {
+            throw std::runtime_error("Multi-point opening has mismatched points and values");
+        }
+        if (opening.points.size() >= srs.g2_powers.size()) {
+            throw std::runtime_error("KZG setup has too few G2 powers for this opening");
+        }
+        Polynomial interpolant = LagrangeInterpolation::interpolate(opening.points, opening.values);
+        G2 vanishing_commitment = msm(srs.g2_powers, vanishingOn(opening.points).coefficients);
+        return Pairing::check({{commitment - commit(interpolant), srs.g2_powers[0]},
+                               {G1() - opening.witness, vanishing_commitment}});
+    }
+
+    // Many single-point openings (any points, any commitments) checked with
+    // one multi-pairing. With independent random r_j:
+    //   e(sum_j r_j (C_j - [y_j]_1 + z_j pi_j), [1]_2) == e(sum_j r_j pi_j, [tau]_2)
+    // A false opening survives only if the r_j hit a root of a fixed,
+    // nonzero linear form, i.e. with probability 1/p. (Powers of a single
+    // challenge would make it a degree n - 1 polynomial and the bound
+    // (n - 1)/p.)
+    bool verifyAll(const std::vector<G1>& commitments, const std::vector<Opening>& openings) const {
+        if (commitments.size() != openings.size()) {
+            throw std::runtime_error("Openings do not match the commitments");
+        }
+        size_t n = openings.size();
+        if (n == 0) return true;
+
+        std::vector<FieldElement> r(n);
+        for (FieldElement& r_j : r) r_j = randomChallenge();
+        std::vector<G1> bases(2 * n + 1);
+        std::vector<FieldElement> scalars(2 * n + 1);
+        std::vector<G1> witnesses(n);
+        FieldElement value_sum(0);
+        for (size_t j = 0; j < n; j++) {
+            bases[j] = commitments[j];
+            scalars[j] = r[j];
+            bases[n + j] = openings[j].witness;
+            scalars[n + j] = r[j] * openings[j].point;
+            witnesses[j] = openings[j].witness;
+            value_sum = value_sum + r[j] * openings[j].value;
+        }
+        bases[2 * n] = Pairing::g1();
+        scalars[2 * n] = FieldElement(0) - value_sum;
+
+        G1 lhs = msm(bases, scalars);
+        G1 rhs = msm(witnesses, r);
+        return Pairing::check({{lhs, srs.g2_powers[0]},
+                               {G1() - rhs, srs.g2_powers[1]}});
+    }
+};
+
+#endif // KZG_H
@@ -0,0 +1,401 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+#include <algorithm>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/vfs.h>
+#endif
+#endif
+
+// Page backing of a mapping
+enum class HugePages {
+    None,
+    // Ask the kernel to back the mapping with transparent huge pages
+    // (madvise MADV_HUGEPAGE); silently a no-op where unsupported
+    Transparent,
+    // The file lives on hugetlbfs, so it is backed by reserved huge pages
+    // and its size is a multiple of the huge page size (Linux only)
+    Explicit
+};
+
+struct MapOptions {
+    HugePages huge_pages = HugePages::None;
+    bool prefault = false;      // fault every page in when mapping
+};
+
+// File mapped into memory. The OS pages data in and out on demand, so a
+// mapping may be far larger than the memory the process can afford.
+// Mappings are shared: processes mapping the same file read one physical
+// copy of it from the page cache.
+class MappedFile {
+public:
+    enum class Mode { ReadOnly, ReadWrite };
+
+private:
+    std::string file_path;
+    void* base;
+    size_t length;
+    Mode mode;
+    bool remove_on_close;
+    MapOptions options;
+#ifdef _WIN32
+    HANDLE file;
+    HANDLE mapping;
+#else
+    int fd;
+#endif
+
+    void map() {
+        if (length == 0) return;
+#ifdef _WIN32
+        DWORD protect = (mode == Mode::ReadWrite) ? PAGE_READWRITE : PAGE_READONLY;
+        DWORD access = (mode == Mode::ReadWrite) ? FILE_MAP_WRITE : FILE_MAP_READ;
+        uint64_t size = length;
+        mapping = CreateFileMappingA(file, nullptr, protect,
+                                     static_cast<DWORD>(size >> 32),
+                                     static_cast<DWORD>(size & 0xFFFFFFFFu), nullptr);
+        if (mapping == nullptr) {
+            throw std::runtime_error("Cannot create file mapping for " + file_path);
+        }
+        base = MapViewOfFile(mapping, access, 0, 0, length);
+        if (base == nullptr) {
+            throw std::runtime_error("Cannot map " + file_path);
+        }
+#else
+        int prot = (mode == Mode::ReadWrite) ? (PROT_READ | PROT_WRITE) : PROT_READ;
+        // With transparent huge pages the advice has to come before the
+        // first fault, so pre-faulting is done after madvise instead of
+        // by MAP_POPULATE
+        bool transparent = options.huge_pages == HugePages::Transparent;
+        int flags = MAP_SHARED;
+#ifdef MAP_POPULATE
+        if (options.prefault && !transparent) flags |= MAP_POPULATE;
+#endif
+        void* addr = mmap(nullptr, length, prot, flags, fd, 0);
+        if (addr == MAP_FAILED) {
+            throw std::runtime_error("Cannot map " + file_path);
+        }
+        base = addr;
+#ifdef MADV_HUGEPAGE
+        // Advice only: kernels without THP for this file type ignore it
+        if (transparent) madvise(base, length, MADV_HUGEPAGE);
+#endif
+#ifdef MAP_POPULATE
+        if (options.prefault && transparent) touchPages();
+#else
+        if (options.prefault) touchPages();
+#endif
+#endif
+#ifdef _WIN32
+        if (options.prefault) touchPages();
+#endif
+    }
+
+#ifndef _WIN32
+    // Huge page size of the hugetlbfs file system holding the open file
+    size_t hugePageSize() const {
+#ifdef __linux__
+        const long HUGETLBFS_MAGIC_NUMBER = 0x958458f6;
+        struct statfs fs;
+        if (fstatfs(fd, &fs) == 0 && static_cast<long>(fs.f_type) == HUGETLBFS_MAGIC_NUMBER) {
+            return static_cast<size_t>(fs.f_bsize);
+        }
+        throw std::runtime_error("Explicit huge pages need a file on hugetlbfs: " + file_path);
+#else
+        throw std::runtime_error("Explicit huge pages are not supported on this platform: " + file_path);
+#endif
+    }
+#endif
+
+    // Read one byte of every page so that later accesses do not fault
+    void touchPages() const {
+        const volatile char* p = static_cast<const volatile char*>(base);
+        const size_t page = 4096;
+        char sink = 0;
+        for (size_t offset = 0; offset < length; offset += page) {
+            sink ^= p[offset];
+        }
+        (void)sink;
+    }
+
+    MappedFile(const std::string& path, Mode m, const MapOptions& opts)
+        : file_path(path), base(nullptr), length(0), mode(m), remove_on_close(false), options(opts) {
+#ifdef _WIN32
+        file = INVALID_HANDLE_VALUE;
+        mapping = nullptr;
+#else
+        fd = -1;
+#endif
+    }
+
+public:
+    MappedFile()
+        : base(nullptr), length(0), mode(Mode::ReadOnly), remove_on_close(false) {
+#ifdef _WIN32
+        file = INVALID_HANDLE_VALUE;
+        mapping = nullptr;
+#else
+        fd = -1;
+#endif
+    }
+
+    // Create (or truncate) a file of `bytes` bytes and map it read-write.
+    // A temporary file is deleted when the mapping is closed. With explicit
+    // huge pages the file is rounded up to a whole number of huge pages.
+    static MappedFile create(const std::string& path, size_t bytes, bool temporary = false,
+                             const MapOptions& opts = MapOptions()) {
+        MappedFile mf(path, Mode::ReadWrite, opts);
+        mf.remove_on_close = temporary;
+#ifdef _WIN32
+        if (opts.huge_pages == HugePages::Explicit) {
+            throw std::runtime_error("Explicit huge pages are not supported on this platform: " + path);
+        }
+        mf.file = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ,
+                              nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (mf.file == INVALID_HANDLE_VALUE) {
+            throw std::runtime_error("Cannot create " + path);
+        }
+#else
+        mf.fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (mf.fd < 0) {
+            throw std::runtime_error("Cannot create " + path);
+        }
+        if (opts.huge_pages == HugePages::Explicit) {
+            size_t huge = mf.hugePageSize();
+            bytes = (bytes + huge - 1) / huge * huge;
+        }
+        if (bytes > 0 && ftruncate(mf.fd, static_cast<off_t>(bytes)) != 0) {
+            throw std::runtime_error("Cannot resize " + path);
+        }
+#endif
+        mf.length = bytes;
+        mf.map();
+        return mf;
+    }
+
+    // Map an existing file
+    static MappedFile open(const std::string& path, Mode m = Mode::ReadOnly,
+                           const MapOptions& opts = MapOptions()) {
+        MappedFile mf(path, m, opts);
+#ifdef _WIN32
+        if (opts.huge_pages == HugePages::Explicit) {
+            throw std::runtime_error("Explicit huge pages are not supported on this platform: " + path);
+        }
+        DWORD access = (m == Mode::ReadWrite) ? (GENERIC_READ | GENERIC_WRITE) : GENERIC_READ;
+        mf.file = CreateFileA(path.c_str(), access, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (mf.file == INVALID_HANDLE_VALUE) {
+            throw std::runtime_error("Cannot open " + path);
+        }
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(mf.file, &size)) {
+            throw std::runtime_error("Cannot stat " + path);
+        }
+        mf.length = static_cast<size_t>(size.QuadPart);
+#else
+        mf.fd = ::open(path.c_str(), (m == Mode::ReadWrite) ? O_RDWR : O_RDONLY);
+        if (mf.fd < 0) {
+            throw std::runtime_error("Cannot open " + path);
+        }
+        struct stat st;
+        if (fstat(mf.fd, &st) != 0) {
+            throw std::runtime_error("Cannot stat " + path);
+        }
+        mf.length = static_cast<size_t>(st.st_size);
+        if (opts.huge_pages == HugePages::Explicit) {
+            mf.hugePageSize();
+        }
+#endif
+        mf.map();
+        return mf;
+    }
+
+    MappedFile(MappedFile&& other) noexcept
+        : file_path(std::move(other.file_path)), base(other.base), length(other.length),
+          mode(other.mode), remove_on_close(other.remove_on_close), options(other.options) {
+#ifdef _WIN32
+        file = other.file;
+        mapping = other.mapping;
+        other.file = INVALID_HANDLE_VALUE;
+        other.mapping = nullptr;
+#else
+        fd = other.fd;
+        other.fd = -1;
+#endif
+        other.base = nullptr;
+        other.length = 0;
+        other.remove_on_close = false;
+    }
+
+    MappedFile& operator=(MappedFile&& other) noexcept {
+        if (this != &other) {
+            close();
+            file_path = std::move(other.file_path);
+            base = other.base;
+            length = other.length;
+            mode = other.mode;
+            remove_on_close = other.remove_on_close;
+            options = other.options;
+#ifdef _WIN32
+            file = other.file;
+            mapping = other.mapping;
+            other.file = INVALID_HANDLE_VALUE;
+            other.mapping = nullptr;
+#else
+            fd = other.fd;
+            other.fd = -1;
+#endif
+            other.base = nullptr;
+            other.length = 0;
+            other.remove_on_close = false;
+        }
+        return *this;
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile() { close(); }
+
+    void close() {
+#ifdef _WIN32
+        if (base != nullptr) UnmapViewOfFile(base);
+        if (mapping != nullptr) CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+        mapping = nullptr;
+        file = INVALID_HANDLE_VALUE;
+#else
+        if (base != nullptr) munmap(base, length);
+        if (fd >= 0) ::close(fd);
+        fd = -1;
+#endif
+        base = nullptr;
+        length = 0;
+        if (remove_on_close) {
+            std::remove(file_path.c_str());
+            remove_on_close = false;
+        }
+    }
+
+    void* data() { return base; }
+    const void* data() const { return base; }
+    size_t size() const { return length; }
+    const std::string& path() const { return file_path; }
+
+    // Ask the OS to start reading a range ahead of use
+    void prefetch(size_t offset, size_t bytes) const {
+        if (base == nullptr || offset >= length) return;
+        bytes = std::min(bytes, length - offset);
+#ifndef _WIN32
+        long page = sysconf(_SC_PAGESIZE);
+        size_t start = offset - offset % static_cast<size_t>(page);
+        madvise(static_cast<char*>(base) + start, bytes + (offset - start), MADV_WILLNEED);
+#endif
+    }
+
+    // Write dirty pages back to the file
+    void flush() {
+        if (base == nullptr) return;
+#ifdef _WIN32
+        FlushViewOfFile(base, length);
+#else
+        msync(base, length, MS_SYNC);
+#endif
+    }
+};
+
+// 64-bit FNV-1a over 8-byte words (the tail is zero-padded). Detects torn
+// or corrupted files; it is not a cryptographic hash. Passing the previous
+// result as `seed` continues a checksum across chunks whose sizes are
+// multiples of 8 bytes.
+constexpr uint64_t CHECKSUM64_SEED = 0xcbf29ce484222325ULL;
+
+inline uint64_t checksum64(const void* data, size_t bytes, uint64_t seed = CHECKSUM64_SEED) {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    uint64_t h = seed;
+    size_t i = 0;
+    for (; i + 8 <= bytes; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, p + i, 8);
+        h ^= word;
+        h *= 0x100000001b3ULL;
+    }
+    if (i < bytes) {
+        uint64_t word = 0;
+        std::memcpy(&word, p + i, bytes - i);
+        h ^= word;
+        h *= 0x100000001b3ULL;
+    }
+    return h;
+}
+
+// Fixed-size array of trivially copyable values stored in a mapped file
+template <typename T>
+class MappedVector {
+    static_assert(std::is_trivially_copyable<T>::value, "MappedVector needs trivially copyable elements");
+
+private:
+    MappedFile file;
+    size_t count;
+
+    explicit MappedVector(MappedFile&& f) : file(std::move(f)), count(file.size() / sizeof(T)) {}
+
+public:
+    MappedVector() : count(0) {}
+
+    static MappedVector create(const std::string& path, size_t n, bool temporary = false) {
+        return MappedVector(MappedFile::create(path, n * sizeof(T), temporary));
+    }
+
+    static MappedVector open(const std::string& path, MappedFile::Mode mode = MappedFile::Mode::ReadOnly) {
+        return MappedVector(MappedFile::open(path, mode));
+    }
+
+    // Spill an in-memory vector to disk
+    static MappedVector fromVector(const std::vector<T>& values, const std::string& path, bool temporary = false) {
+        MappedVector mv = create(path, values.size(), temporary);
+        if (!values.empty()) {
+            std::memcpy(mv.data(), values.data(), values.size() * sizeof(T));
+        }
+        return mv;
+    }
+
+    std::vector<T> toVector() const {
+        return std::vector<T>(data(), data() + count);
+    }
+
+    T* data() { return static_cast<T*>(file.data()); }
+    const T* data() const { return static_cast<const T*>(file.data()); }
+    size_t size() const { return count; }
+    T& operator[](size_t i) { return data()[i]; }
+    const T& operator[](size_t i) const { return data()[i]; }
+
+    void prefetch(size_t first, size_t n) const { file.prefetch(first * sizeof(T), n * sizeof(T)); }
+    void flush() { file.flush(); }
+    const std::string& path() const { return file.path(); }
+};
+
+#endif // MAPPED_FILE_H
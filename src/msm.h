@@ -0,0 +1,107 @@
+#ifndef MSM_H
+#define MSM_H
+
+#include "field.h"
+#include "parallel.h"
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <cstdint>
+
+// Multi-scalar multiplication  sum_i scalars[i] * bases[i].
+//
+// Works for any group type whose default constructor is the identity and
+// which provides operator+ (doubling is P + P), e.g. the group elements
+// of a pairing backend.
+
+// Bits in a scalar (field elements are below 2^31)
+constexpr unsigned MSM_SCALAR_BITS = 31;
+
+// Pippenger window width for n terms: about log2(n) - 2 bits, so each
+// window costs n bucket additions plus 2^c to sum the buckets
+inline unsigned msmWindowBits(size_t n) {
+    unsigned bits = 0;
+    while ((size_t(1) << bits) < n) bits++;
+    return std::min<unsigned>(16, std::max<unsigned>(2, bits > 3 ? bits - 2 : 2));
+}
+
+// Double-and-add for a single term
+template <typename Point>
+Point scalarMultiply(const Point& base, uint64_t scalar) {
+    Point result;
+    Point addend = base;
+    while (scalar > 0) {
+        if (scalar & 1) result = result + addend;
+        scalar >>= 1;
+        if (scalar > 0) addend = addend + addend;
+    }
+    return result;
+}
+
+// Pippenger's bucket method: O(n * 31 / c + 2^c * 31 / c) group additions
+// instead of O(31 n) for independent double-and-add. Each c-bit window is
+// reduced independently (windows run in parallel), then the window sums
+// are combined with c doublings between them.
+//
+// Sums are kept in the accumulator type Acc, which must be constructible
+// from a base and support Acc + base and Acc + Acc; `bases[i]` may be any
+// indexable source (a vector, or a view over a mapped file).
+template <typename Acc, typename Bases>
+Acc msmAccumulate(const Bases& bases, const FieldElement* scalars, size_t n) {
+    if (n == 0) return Acc();
+
+    if (n < 8) {
+        Acc result;
+        for (size_t i = 0; i < n; i++) {
+            result = result + scalarMultiply(Acc(bases[i]), scalars[i].getValue());
+        }
+        return result;
+    }
+
+    unsigned c = msmWindowBits(n);
+    size_t windows = (MSM_SCALAR_BITS + c - 1) / c;
+    uint64_t mask = (uint64_t(1) << c) - 1;
+    std::vector<Acc> window_sums(windows);
+
+    parallelFor(0, windows, 1, [&](size_t lo, size_t hi) {
+        std::vector<Acc> buckets(mask);
+        for (size_t w = lo; w < hi; w++) {
+            std::fill(buckets.begin(), buckets.end(), Acc());
+            unsigned shift = static_cast<unsigned>(w) * c;
+            for (size_t i = 0; i < n; i++) {
+                uint64_t digit = (scalars[i].getValue() >> shift) & mask;
+                if (digit != 0) {
+                    buckets[digit - 1] = buckets[digit - 1] + bases[i];
+                }
+            }
+
+            // sum_d d * bucket_d as a running sum from the top bucket down
+            Acc running;
+            Acc total;
+            for (size_t d = mask; d-- > 0;) {
+                running = running + buckets[d];
+                total = total + running;
+            }
+            window_sums[w] = total;
+        }
+    });
+
+    Acc result = window_sums[windows - 1];
+    for (size_t w = windows - 1; w-- > 0;) {
+        for (unsigned b = 0; b < c; b++) {
+            result = result + result;
+        }
+        result = result + window_sums[w];
+    }
+    return result;
+}
+
+template <typename Point>
+Point msm(const std::vector<Point>& bases, const std::vector<FieldElement>& scalars) {
+    if (scalars.size() > bases.size()) {
+        throw std::runtime_error("MSM has more scalars than bases");
+    }
+    return msmAccumulate<Point>(bases, scalars.data(), scalars.size());
+}
+
+#endif // MSM_H
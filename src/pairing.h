@@ -0,0 +1,97 @@
+#ifndef PAIRING_H
+#define PAIRING_H
+
+#include "field.h"
+#include <vector>
+#include <utility>
+#include <iostream>
+#include <cstdint>
+
+// Element of the toy pairing groups: the additive group of the field,
+// stored by its discrete log with respect to the generator 1.
+//
+// This is NOT a secure group (discrete logs are the stored values). It
+// exists so that pairing-based protocols can be run and checked end to end
+// on this project's field, which has no pairing-friendly curve: the
+// algebra (bilinearity, non-degeneracy) is exactly that of a real pairing.
+class ToyGroupElement {
+private:
+    FieldElement value;
+
+public:
+    static constexpr size_t BYTES = 4;
+
+    ToyGroupElement() : value(0) {} // identity
+    explicit ToyGroupElement(const FieldElement& discrete_log) : value(discrete_log) {}
+
+    static ToyGroupElement generator() { return ToyGroupElement(FieldElement(1)); }
+
+    ToyGroupElement operator+(const ToyGroupElement& other) const { return ToyGroupElement(value + other.value); }
+    ToyGroupElement operator-(const ToyGroupElement& other) const { return ToyGroupElement(value - other.value); }
+    ToyGroupElement operator*(const FieldElement& scalar) const { return ToyGroupElement(value * scalar); }
+    ToyGroupElement operator*(uint64_t scalar) const { return ToyGroupElement(value * FieldElement(scalar)); }
+
+    bool isIdentity() const { return value == FieldElement(0); }
+    bool operator==(const ToyGroupElement& other) const { return value == other.value; }
+    bool operator!=(const ToyGroupElement& other) const { return value != other.value; }
+
+    // Only the pairing may look at the discrete log
+    FieldElement discreteLog() const { return value; }
+
+    void toBytes(unsigned char* out) const {
+        uint32_t v = static_cast<uint32_t>(value.getValue());
+        for (size_t i = 0; i < BYTES; i++) out[i] = static_cast<unsigned char>(v >> (8 * i));
+    }
+
+    static ToyGroupElement fromBytes(const unsigned char* in) {
+        uint32_t v = 0;
+        for (size_t i = 0; i < BYTES; i++) v |= static_cast<uint32_t>(in[i]) << (8 * i);
+        return ToyGroupElement(FieldElement(v));
+    }
+
+    friend std::ostream& operator<<(std::ostream& os, const ToyGroupElement& e) {
+        os << "[" << e.value << "]";
+        return os;
+    }
+};
+
+// Pairing backend interface used by the pairing-based schemes (see kzg.h
+// and zksnark.h):
+//   G1, G2          group element types (identity by default, +, -, * scalar,
+//                   isIdentity, BYTES / toBytes / fromBytes)
+//   GT              target group
+//   g1(), g2()      generators
+//   pair(P, Q)      e(P, Q), for values fixed once (e.g. e(alpha, beta))
+//   check(pairs)    true iff the product of e(P_i, Q_i) is the identity, or
+//                   equals `target` when one is given
+//
+// ToyPairing implements it with G1 = G2 = (F_p, +) and e(a, b) = a * b.
+// A real backend (BN254, BLS12-381) plugs in with the same interface.
+struct ToyPairing {
+    using G1 = ToyGroupElement;
+    using G2 = ToyGroupElement;
+    using GT = FieldElement;    // written additively, like G1 and G2
+
+    static G1 g1() { return G1::generator(); }
+    static G2 g2() { return G2::generator(); }
+
+    static GT pair(const G1& p, const G2& q) {
+        return p.discreteLog() * q.discreteLog();
+    }
+
+    // Multi-pairing check: one final "exponentiation" for all pairs.
+    // GT is written additively here, so the product of pairings is a sum.
+    static bool check(const std::pair<G1, G2>* pairs, size_t count, const GT& target = GT(0)) {
+        GT acc(0);
+        for (size_t i = 0; i < count; i++) {
+            acc = acc + pair(pairs[i].first, pairs[i].second);
+        }
+        return acc == target;
+    }
+
+    static bool check(const std::vector<std::pair<G1, G2>>& pairs, const GT& target = GT(0)) {
+        return check(pairs.data(), pairs.size(), target);
+    }
+};
+
+#endif // PAIRING_H
@@ -0,0 +1,178 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <thread>
+#include <vector>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <exception>
+#include <algorithm>
+#include <cstddef>
+
+// Number of worker threads used by the parallel kernels
+inline size_t parallelism() {
+    unsigned int hw = std::thread::hardware_concurrency();
+    return hw == 0 ? 1 : hw;
+}
+
+// Fixed set of worker threads fed from one task queue. Threads live as long
+// as the pool, so their thread-local scratch arenas stay warm between calls.
+class ThreadPool {
+private:
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable available;
+    std::condition_variable progress;   // a task was queued or a helper's wait may be over
+    bool stopping;
+
+    void workerLoop() {
+        while (true) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                available.wait(lock, [this]() { return stopping || !tasks.empty(); });
+                if (stopping && tasks.empty()) return;
+                task = std::move(tasks.front());
+                tasks.pop_front();
+            }
+            task();
+        }
+    }
+
+public:
+    explicit ThreadPool(size_t threads) : stopping(false) {
+        for (size_t i = 0; i < threads; i++) {
+            workers.emplace_back([this]() { workerLoop(); });
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        available.notify_all();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t size() const { return workers.size(); }
+
+    void submit(std::function<void()> task) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            tasks.push_back(std::move(task));
+        }
+        available.notify_one();
+        progress.notify_all();
+    }
+
+    // Run one queued task on the calling thread; false if the queue is empty.
+    // Threads waiting on their own tasks call this so nested parallel loops
+    // cannot deadlock the pool.
+    bool runPendingTask() {
+        std::function<void()> task;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (tasks.empty()) return false;
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+        task();
+        return true;
+    }
+
+    // Run queued tasks on the calling thread until done() holds, sleeping
+    // while there is nothing to run. done() is checked under the pool lock,
+    // so whatever makes it true must call notifyProgress() afterwards.
+    template <typename Done>
+    void helpUntil(Done done) {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!done()) {
+            if (tasks.empty()) {
+                progress.wait(lock);
+                continue;
+            }
+            std::function<void()> task = std::move(tasks.front());
+            tasks.pop_front();
+            lock.unlock();
+            task();
+            lock.lock();
+        }
+    }
+
+    // Wake the threads sleeping in helpUntil to recheck their condition
+    void notifyProgress() {
+        { std::lock_guard<std::mutex> lock(mutex); }
+        progress.notify_all();
+    }
+
+    // Process-wide pool: the calling thread always takes part in the work,
+    // so one fewer worker than hardware threads is started. At least one
+    // runs, so tasks submitted without a waiting caller (async_prover.h)
+    // still make progress on a single core.
+    static ThreadPool& shared() {
+        static ThreadPool pool(std::max<size_t>(parallelism() - 1, 1));
+        return pool;
+    }
+};
+
+// Split [begin, end) into contiguous chunks of at least min_chunk elements
+// and run fn(lo, hi) on each chunk using the shared pool. Chunks are
+// disjoint, so fn may write to its own slice of a shared output without
+// locking, and results land at fixed positions whatever the scheduling.
+// Small ranges run inline. The first exception thrown by fn is rethrown.
+template <typename Fn>
+void parallelFor(size_t begin, size_t end, size_t min_chunk, Fn fn) {
+    if (end <= begin) return;
+
+    size_t total = end - begin;
+    size_t grain = std::max<size_t>(min_chunk, 1);
+    size_t chunks = std::min(parallelism(), (total + grain - 1) / grain);
+    if (chunks <= 1) {
+        fn(begin, end);
+        return;
+    }
+
+    ThreadPool& pool = ThreadPool::shared();
+    size_t chunk_size = (total + chunks - 1) / chunks;
+    std::atomic<size_t> remaining(0);
+    std::exception_ptr error;
+    std::mutex error_mutex;
+
+    auto run = [&](size_t lo, size_t hi) {
+        try {
+            fn(lo, hi);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(error_mutex);
+            if (!error) error = std::current_exception();
+        }
+    };
+
+    for (size_t lo = begin + chunk_size; lo < end; lo += chunk_size) {
+        size_t hi = std::min(lo + chunk_size, end);
+        remaining++;
+        // The waiter may return as soon as remaining hits zero: after the
+        // decrement the task touches only the pool, captured by pointer
+        pool.submit([&run, &remaining, lo, hi, owner = &pool]() {
+            run(lo, hi);
+            if (--remaining == 0) owner->notifyProgress();
+        });
+    }
+    run(begin, std::min(begin + chunk_size, end));
+
+    // Help with queued work while chunks are out; sleep once there is none
+    pool.helpUntil([&]() { return remaining.load() == 0; });
+
+    if (error) std::rethrow_exception(error);
+}
+
+#endif // PARALLEL_H
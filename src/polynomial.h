@@ -0,0 +1,346 @@
+#ifndef POLYNOMIAL_H
+#define POLYNOMIAL_H
+
+#include "field.h"
+#include "parallel.h"
+#include "arena.h"
+#include "mapped_file.h"
+#include <vector>
+#include <iostream>
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+#include <string>
+
+// Polynomial representation
+class Polynomial {
+public:
+    std::vector<FieldElement> coefficients; // coefficients[i] is the coefficient of x^i
+    
+    Polynomial() {}
+    Polynomial(const std::vector<FieldElement>& coeffs) : coefficients(coeffs) {}
+    Polynomial(std::vector<FieldElement>&& coeffs) : coefficients(std::move(coeffs)) {}
+    
+    // Evaluate polynomial at point x
+    FieldElement evaluate(const FieldElement& x) const {
+        FieldElement result(0);
+        FieldElement x_power(1);
+        
+        for (const auto& coeff : coefficients) {
+            result = result + coeff * x_power;
+            x_power = x_power * x;
+        }
+        
+        return result;
+    }
+
+    // Points evaluated together by the Horner kernel in evaluateMany
+    static constexpr size_t EVAL_LANES = 8;
+
+    // Evaluate at every point in xs (arbitrary points, where no NTT
+    // applies). Horner's rule runs on EVAL_LANES points at once: one
+    // coefficient load feeds all lanes, and each lane is a 32x32->64-bit
+    // multiply plus two Mersenne folds with no branches, so the inner loop
+    // vectorises. Chunks of points are spread over the thread pool.
+    std::vector<FieldElement> evaluateMany(const std::vector<FieldElement>& xs) const {
+        std::vector<FieldElement> result(xs.size(), FieldElement(0));
+        if (coefficients.empty() || xs.empty()) return result;
+
+        const FieldElement* coeffs = coefficients.data();
+        size_t count = coefficients.size();
+        size_t min_chunk = std::max<size_t>(EVAL_LANES, (size_t(1) << 16) / count);
+
+        parallelFor(0, xs.size(), min_chunk, [&](size_t lo, size_t hi) {
+            for (size_t base = lo; base < hi; base += EVAL_LANES) {
+                size_t lanes = std::min(EVAL_LANES, hi - base);
+                uint32_t x[EVAL_LANES] = {};
+                uint32_t acc[EVAL_LANES] = {};
+                for (size_t l = 0; l < lanes; l++) {
+                    x[l] = static_cast<uint32_t>(xs[base + l].getValue());
+                }
+
+                // acc < 2^32 between steps, so acc * x < 2^63
+                for (size_t k = count; k-- > 0;) {
+                    uint64_t c = coeffs[k].getValue();
+                    for (size_t l = 0; l < EVAL_LANES; l++) {
+                        uint64_t t = FieldElement::foldProduct(uint64_t(acc[l]) * x[l]) + c;
+                        acc[l] = static_cast<uint32_t>(FieldElement::foldProduct(t));
+                    }
+                }
+
+                for (size_t l = 0; l < lanes; l++) {
+                    result[base + l] = FieldElement(acc[l]);
+                }
+            }
+        });
+        return result;
+    }
+
+    // In-place addition
+    Polynomial& operator+=(const Polynomial& other) {
+        if (other.coefficients.size() > coefficients.size()) {
+            coefficients.resize(other.coefficients.size(), FieldElement(0));
+        }
+        for (size_t i = 0; i < other.coefficients.size(); i++) {
+            coefficients[i] = coefficients[i] + other.coefficients[i];
+        }
+        return *this;
+    }
+    
+    // In-place subtraction
+    Polynomial& operator-=(const Polynomial& other) {
+        if (other.coefficients.size() > coefficients.size()) {
+            coefficients.resize(other.coefficients.size(), FieldElement(0));
+        }
+        for (size_t i = 0; i < other.coefficients.size(); i++) {
+            coefficients[i] = coefficients[i] - other.coefficients[i];
+        }
+        return *this;
+    }
+    
+    // In-place scalar multiplication
+    Polynomial& operator*=(const FieldElement& scalar) {
+        for (auto& coeff : coefficients) {
+            coeff = coeff * scalar;
+        }
+        return *this;
+    }
+    
+    // In-place polynomial multiplication
+    Polynomial& operator*=(const Polynomial& other) {
+        *this = *this * other;
+        return *this;
+    }
+    
+    // Add polynomials (an rvalue left operand is reused as the result)
+    Polynomial operator+(const Polynomial& other) const & {
+        Polynomial result(*this);
+        result += other;
+        return result;
+    }
+    Polynomial operator+(const Polynomial& other) && {
+        *this += other;
+        return std::move(*this);
+    }
+    
+    // Subtract polynomials
+    Polynomial operator-(const Polynomial& other) const & {
+        Polynomial result(*this);
+        result -= other;
+        return result;
+    }
+    Polynomial operator-(const Polynomial& other) && {
+        *this -= other;
+        return std::move(*this);
+    }
+    
+    // Multiply polynomials
+    Polynomial operator*(const Polynomial& other) const {
+        if (coefficients.empty() || other.coefficients.empty()) {
+            return Polynomial();
+        }
+        
+        std::vector<FieldElement> result_coeffs(
+            coefficients.size() + other.coefficients.size() - 1, 
+            FieldElement(0)
+        );
+        
+        for (size_t i = 0; i < coefficients.size(); i++) {
+            if (coefficients[i] == FieldElement(0)) continue;
+            for (size_t j = 0; j < other.coefficients.size(); j++) {
+                result_coeffs[i + j] = result_coeffs[i + j] + coefficients[i] * other.coefficients[j];
+            }
+        }
+        
+        return Polynomial(std::move(result_coeffs));
+    }
+    
+    // Scalar multiplication
+    Polynomial operator*(const FieldElement& scalar) const & {
+        std::vector<FieldElement> result_coeffs(coefficients.size());
+        for (size_t i = 0; i < coefficients.size(); i++) {
+            result_coeffs[i] = coefficients[i] * scalar;
+        }
+        return Polynomial(std::move(result_coeffs));
+    }
+    Polynomial operator*(const FieldElement& scalar) && {
+        *this *= scalar;
+        return std::move(*this);
+    }
+    
+    // Fused multi-axpy: out = sum_i scalars[i] * polys[i], written into the
+    // caller's buffer (its capacity is reused). Zero scalars are skipped.
+    // Products are folded to below 2^32 and summed in 64-bit accumulators,
+    // so each output coefficient is reduced once instead of once per term.
+    // Coefficient blocks are processed in parallel.
+    static void linearCombination(const std::vector<Polynomial>& polys,
+                                  const std::vector<FieldElement>& scalars,
+                                  Polynomial& out) {
+        if (scalars.size() < polys.size()) {
+            throw std::runtime_error("Not enough scalars for linear combination");
+        }
+        
+        std::vector<size_t> active;
+        size_t out_size = 1;
+        for (size_t i = 0; i < polys.size(); i++) {
+            if (scalars[i] == FieldElement(0) || polys[i].coefficients.empty()) continue;
+            active.push_back(i);
+            out_size = std::max(out_size, polys[i].coefficients.size());
+        }
+        
+        out.coefficients.assign(out_size, FieldElement(0));
+        if (active.empty()) return;
+        
+        // Each folded product is < 2^32, so 2^31 of them fit in 64 bits
+        const size_t max_lazy_terms = size_t(1) << 31;
+        
+        parallelFor(0, out_size, 1024, [&](size_t lo, size_t hi) {
+            ArenaScope scope(scratchArena());
+            std::pmr::vector<uint64_t> acc(hi - lo, 0, &scratchArena());
+            size_t pending = 0;
+            
+            for (size_t i : active) {
+                const std::vector<FieldElement>& coeffs = polys[i].coefficients;
+                uint64_t w = scalars[i].getValue();
+                size_t end = std::min(hi, coeffs.size());
+                for (size_t k = lo; k < end; k++) {
+                    acc[k - lo] += FieldElement::foldProduct(w * coeffs[k].getValue());
+                }
+                
+                if (++pending == max_lazy_terms) {
+                    for (auto& a : acc) a %= FieldElement::getPrime();
+                    pending = 0;
+                }
+            }
+            
+            for (size_t k = lo; k < hi; k++) {
+                out.coefficients[k] = FieldElement(acc[k - lo]);
+            }
+        });
+    }
+    
+    // Copy the coefficients to a file-backed vector so large polynomials can
+    // go through the out-of-core NTT without staying resident
+    MappedVector<FieldElement> spillToFile(const std::string& path, bool temporary = true) const {
+        return MappedVector<FieldElement>::fromVector(coefficients, path, temporary);
+    }
+    
+    // Load a polynomial back from a file-backed coefficient vector
+    static Polynomial fromMapped(const MappedVector<FieldElement>& mapped) {
+        return Polynomial(mapped.toVector());
+    }
+    
+    // Degree ignoring trailing zero coefficients (-1 for the zero polynomial)
+    int degree() const {
+        for (size_t i = coefficients.size(); i-- > 0;) {
+            if (coefficients[i] != FieldElement(0)) return static_cast<int>(i);
+        }
+        return -1;
+    }
+
+    // Long division: returns the quotient and stores the remainder
+    Polynomial divide(const Polynomial& divisor, Polynomial& remainder) const {
+        int divisor_degree = divisor.degree();
+        if (divisor_degree < 0) {
+            throw std::runtime_error("Division by zero polynomial");
+        }
+
+        std::vector<FieldElement> rem = coefficients;
+        int rem_degree = degree();
+        if (rem_degree < divisor_degree) {
+            remainder = Polynomial(rem);
+            return Polynomial({FieldElement(0)});
+        }
+
+        std::vector<FieldElement> quot(rem_degree - divisor_degree + 1, FieldElement(0));
+        FieldElement lead_inv = divisor.coefficients[divisor_degree].inverse();
+
+        for (int i = rem_degree; i >= divisor_degree; i--) {
+            FieldElement factor = rem[i] * lead_inv;
+            quot[i - divisor_degree] = factor;
+            if (factor == FieldElement(0)) continue;
+            for (int j = 0; j <= divisor_degree; j++) {
+                rem[i - divisor_degree + j] = rem[i - divisor_degree + j] - factor * divisor.coefficients[j];
+            }
+        }
+
+        rem.resize(divisor_degree > 0 ? divisor_degree : 1);
+        remainder = Polynomial(rem);
+        return Polynomial(quot);
+    }
+
+    void print() const {
+        std::cout << "[";
+        for (size_t i = 0; i < coefficients.size(); i++) {
+            std::cout << coefficients[i];
+            if (i < coefficients.size() - 1) std::cout << ", ";
+        }
+        std::cout << "]";
+    }
+};
+
+// Lagrange interpolation for creating polynomials
+class LagrangeInterpolation {
+public:
+    // Write the coefficients of L_j(x) into `out` (which must hold
+    // x_values.size() elements). Works in place: no temporaries.
+    template <typename Buffer>
+    static void basisInto(size_t j, const std::vector<FieldElement>& x_values, Buffer& out) {
+        std::fill(out.begin(), out.end(), FieldElement(0));
+        out[0] = FieldElement(1);
+        size_t degree = 0;
+        FieldElement denominator(1);
+        
+        for (size_t i = 0; i < x_values.size(); i++) {
+            if (i == j) continue;
+            
+            // Multiply by (x - x_i), from the top coefficient down
+            degree++;
+            for (size_t k = degree; k > 0; k--) {
+                out[k] = out[k - 1] - x_values[i] * out[k];
+            }
+            out[0] = FieldElement(0) - x_values[i] * out[0];
+            
+            denominator = denominator * (x_values[j] - x_values[i]);
+        }
+        
+        FieldElement scale = FieldElement(1) / denominator;
+        for (auto& coeff : out) {
+            coeff = coeff * scale;
+        }
+    }
+    
+    // Create Lagrange basis polynomial L_j(x) that is 1 at x_j and 0 at all other x_i
+    static Polynomial basisPolynomial(int j, const std::vector<FieldElement>& x_values) {
+        std::vector<FieldElement> coeffs(std::max<size_t>(x_values.size(), 1));
+        basisInto(j, x_values, coeffs);
+        return Polynomial(std::move(coeffs));
+    }
+    
+    // Interpolate polynomial through points (x_i, y_i)
+    static Polynomial interpolate(const std::vector<FieldElement>& x_values,
+                                  const std::vector<FieldElement>& y_values) {
+        if (x_values.size() != y_values.size()) {
+            throw std::runtime_error("x and y value sizes must match");
+        }
+        
+        size_t n = std::max<size_t>(x_values.size(), 1);
+        std::vector<FieldElement> result(n, FieldElement(0));
+        
+        // One scratch basis buffer, reused for every j
+        ArenaScope scope(scratchArena());
+        std::pmr::vector<FieldElement> basis(n, &scratchArena());
+        
+        for (size_t j = 0; j < x_values.size(); j++) {
+            if (y_values[j] == FieldElement(0)) continue;
+            basisInto(j, x_values, basis);
+            for (size_t k = 0; k < n; k++) {
+                result[k] = result[k] + basis[k] * y_values[j];
+            }
+        }
+        
+        return Polynomial(std::move(result));
+    }
+};
+
+#endif // POLYNOMIAL_H
@@ -0,0 +1,706 @@
+#ifndef PROVER_SERVER_H
+#define PROVER_SERVER_H
+
+#include "field.h"
+#include "qap.h"
+#include "zksnark.h"
+#include "proving_key_file.h"
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+#include <stdexcept>
+
+#ifdef _WIN32
+#error "prover_server.h needs POSIX sockets (Unix domain sockets)"
+#endif
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/time.h>
+#include <poll.h>
+#include <unistd.h>
+#include <cerrno>
+
+// Long-running prover: circuits and proving keys are loaded once, and
+// proof jobs arrive over a Unix domain socket.
+//
+// Protocol (all integers little-endian; field elements are u32 below p):
+//   request   u32 magic "PRQ1", u32 kind, u64 job id, u32 circuit id,
+//             u32 count, u32 values[count]
+//   response  u32 magic "PRS1", u32 status, u64 job id,
+//             u64 queue_us, u64 prove_us, u64 total_us,
+//             proof A, B, C serialised in 8-byte slots (G1 / G2 toBytes)
+// The values are the full witness (JobKind::Witness), or inputs that the
+// circuit's witness generator extends to one (JobKind::Inputs).
+// Responses carry the job id and may arrive out of order when a client
+// has several jobs in flight.
+//
+// A request is checked against its circuit before its payload is read:
+// the count must be the circuit's witness or input size, so the header
+// cannot make the server allocate more than a real job needs. Responses
+// are written with a send timeout; a client that stops reading is
+// disconnected instead of stalling the workers.
+//
+// Jobs wait in a bounded queue. When it is full a job is answered at once
+// with JobStatus::Busy rather than queued, so load beyond capacity turns
+// into client-side retries instead of unbounded memory and latency.
+// Draining stops accepting connections and jobs (answered ShuttingDown),
+// finishes and answers every queued job, then closes the connections.
+
+enum class JobKind : uint32_t { Witness = 1, Inputs = 2 };
+
+enum class JobStatus : uint32_t {
+    Ok = 0,
+    Busy = 1,             // queue full: retry later
+    UnknownCircuit = 2,
+    InvalidWitness = 3,   // wrong size or does not satisfy the circuit
+    BadRequest = 4,
+    ShuttingDown = 5,
+    InternalError = 6
+};
+
+struct ProofRequest {
+    uint64_t job_id = 0;
+    uint32_t circuit_id = 0;
+    JobKind kind = JobKind::Witness;
+    std::vector<FieldElement> values;
+};
+
+struct ProofResponse {
+    uint64_t job_id = 0;
+    JobStatus status = JobStatus::InternalError;
+    uint64_t queue_us = 0;      // received -> picked up by a worker
+    uint64_t prove_us = 0;      // witness generation and proving
+    uint64_t total_us = 0;      // received -> response written
+    Proof proof;
+};
+
+namespace prover_protocol {
+
+constexpr uint32_t REQUEST_MAGIC = 0x31515250;  // "PRQ1"
+constexpr uint32_t RESPONSE_MAGIC = 0x31535250; // "PRS1"
+constexpr size_t REQUEST_HEADER_BYTES = 24;
+constexpr size_t RESPONSE_BYTES = 64;
+
+inline void putU32(unsigned char* out, uint32_t v) {
+    for (size_t i = 0; i < 4; i++) out[i] = static_cast<unsigned char>(v >> (8 * i));
+}
+
+inline void putU64(unsigned char* out, uint64_t v) {
+    for (size_t i = 0; i < 8; i++) out[i] = static_cast<unsigned char>(v >> (8 * i));
+}
+
+inline uint32_t getU32(const unsigned char* in) {
+    uint32_t v = 0;
+    for (size_t i = 0; i < 4; i++) v |= static_cast<uint32_t>(in[i]) << (8 * i);
+    return v;
+}
+
+inline uint64_t getU64(const unsigned char* in) {
+    uint64_t v = 0;
+    for (size_t i = 0; i < 8; i++) v |= static_cast<uint64_t>(in[i]) << (8 * i);
+    return v;
+}
+
+// Proof elements travel in their serialised form, one 8-byte slot each
+static_assert(ToyPairing::G1::BYTES <= 8 && ToyPairing::G2::BYTES <= 8,
+              "Proof elements do not fit the response slots");
+
+// Whole-buffer socket I/O; false once the peer is gone
+inline bool readFully(int fd, void* data, size_t bytes) {
+    unsigned char* p = static_cast<unsigned char*>(data);
+    while (bytes > 0) {
+        ssize_t n = ::read(fd, p, bytes);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        p += n;
+        bytes -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// Read and drop the payload of a rejected request, in bounded pieces
+inline bool skipFully(int fd, size_t bytes) {
+    unsigned char sink[4096];
+    while (bytes > 0) {
+        size_t n = std::min(bytes, sizeof(sink));
+        if (!readFully(fd, sink, n)) return false;
+        bytes -= n;
+    }
+    return true;
+}
+
+// False also when a send timeout (SO_SNDTIMEO) expires
+inline bool writeFully(int fd, const void* data, size_t bytes) {
+#ifdef MSG_NOSIGNAL
+    const int flags = MSG_NOSIGNAL; // a vanished client must not raise SIGPIPE
+#else
+    const int flags = 0;
+#endif
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    while (bytes > 0) {
+        ssize_t n = ::send(fd, p, bytes, flags);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        p += n;
+        bytes -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+inline std::vector<unsigned char> encodeRequest(const ProofRequest& request) {
+    std::vector<unsigned char> frame(REQUEST_HEADER_BYTES + 4 * request.values.size());
+    putU32(frame.data(), REQUEST_MAGIC);
+    putU32(frame.data() + 4, static_cast<uint32_t>(request.kind));
+    putU64(frame.data() + 8, request.job_id);
+    putU32(frame.data() + 16, request.circuit_id);
+    putU32(frame.data() + 20, static_cast<uint32_t>(request.values.size()));
+    for (size_t i = 0; i < request.values.size(); i++) {
+        putU32(frame.data() + REQUEST_HEADER_BYTES + 4 * i, static_cast<uint32_t>(request.values[i].getValue()));
+    }
+    return frame;
+}
+
+inline void encodeResponse(const ProofResponse& response, unsigned char* out) {
+    putU32(out, RESPONSE_MAGIC);
+    putU32(out + 4, static_cast<uint32_t>(response.status));
+    putU64(out + 8, response.job_id);
+    putU64(out + 16, response.queue_us);
+    putU64(out + 24, response.prove_us);
+    putU64(out + 32, response.total_us);
+    std::memset(out + 40, 0, 24);
+    response.proof.A.toBytes(out + 40);
+    response.proof.B.toBytes(out + 48);
+    response.proof.C.toBytes(out + 56);
+}
+
+inline ProofResponse decodeResponse(const unsigned char* in) {
+    if (getU32(in) != RESPONSE_MAGIC) {
+        throw std::runtime_error("Malformed prover response");
+    }
+    ProofResponse response;
+    response.status = static_cast<JobStatus>(getU32(in + 4));
+    response.job_id = getU64(in + 8);
+    response.queue_us = getU64(in + 16);
+    response.prove_us = getU64(in + 24);
+    response.total_us = getU64(in + 32);
+    if (response.status == JobStatus::Ok) {
+        response.proof.A = ToyPairing::G1::fromBytes(in + 40);
+        response.proof.B = ToyPairing::G2::fromBytes(in + 48);
+        response.proof.C = ToyPairing::G1::fromBytes(in + 56);
+    }
+    return response;
+}
+
+inline sockaddr_un socketAddress(const std::string& path) {
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) {
+        throw std::runtime_error("Socket path is too long: " + path);
+    }
+    std::memcpy(address.sun_path, path.c_str(), path.size());
+    return address;
+}
+
+inline int connectTo(const std::string& path) {
+    sockaddr_un address = socketAddress(path);
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot create socket");
+    }
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+} // namespace prover_protocol
+
+struct ProverServerOptions {
+    size_t queue_capacity = 64;     // jobs waiting for a worker
+    size_t workers = 1;             // concurrent proofs (each also uses the shared pool)
+    size_t max_connections = 64;
+    size_t max_values = size_t(1) << 24;    // longest payload skipped for a rejected job
+    int send_timeout_ms = 5000;             // a client that stops reading is dropped
+};
+
+class ProverServer {
+public:
+    // Extends a job's inputs to the full witness
+    using WitnessGenerator = std::function<std::vector<FieldElement>(const std::vector<FieldElement>&)>;
+
+    struct Stats {
+        uint64_t connections = 0;
+        uint64_t completed = 0;     // jobs answered Ok
+        uint64_t failed = 0;        // jobs answered with an error
+        uint64_t rejected = 0;      // jobs answered Busy
+    };
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Circuit {
+        QAP qap;
+        ProvingKey key;
+        std::unique_ptr<MappedProvingKey> mapped_key;
+        WitnessGenerator generate;
+        size_t input_count = 0;     // values the generator takes
+    };
+
+    struct Connection {
+        int fd;
+        std::mutex write_mutex;     // workers and the reader answer concurrently
+        bool broken = false;        // a write failed or timed out
+
+        explicit Connection(int descriptor) : fd(descriptor) {}
+        ~Connection() { ::close(fd); }
+
+        // A failed or partial write leaves the stream unusable: shut the
+        // socket down so the reader stops, and drop later responses
+        void send(const ProofResponse& response) {
+            unsigned char frame[prover_protocol::RESPONSE_BYTES];
+            prover_protocol::encodeResponse(response, frame);
+            std::lock_guard<std::mutex> lock(write_mutex);
+            if (broken) return;
+            if (!prover_protocol::writeFully(fd, frame, sizeof(frame))) {
+                broken = true;
+                ::shutdown(fd, SHUT_RDWR);
+            }
+        }
+    };
+
+    struct Job {
+        std::shared_ptr<Connection> connection;
+        ProofRequest request;
+        Clock::time_point received;
+    };
+
+    // The socket closes once its reader and its queued jobs are done with
+    // it, so the acceptor only keeps a weak reference
+    struct ReaderThread {
+        std::weak_ptr<Connection> connection;
+        std::shared_ptr<std::atomic<bool>> finished;
+        std::thread thread;
+    };
+
+    std::string socket_path;
+    ProverServerOptions options;
+    std::map<uint32_t, Circuit> circuits;
+
+    int listen_fd = -1;
+    int wake_pipe[2] = {-1, -1};
+    std::thread acceptor;
+    std::vector<std::thread> workers;
+    std::vector<ReaderThread> readers;  // owned by the acceptor until draining
+    bool running = false;
+
+    std::mutex queue_mutex;
+    std::condition_variable queue_ready;
+    std::deque<Job> queue;
+    bool queue_closed = false;
+
+    std::atomic<uint64_t> connections_count{0};
+    std::atomic<uint64_t> completed_count{0};
+    std::atomic<uint64_t> failed_count{0};
+    std::atomic<uint64_t> rejected_count{0};
+
+    static uint64_t microseconds(Clock::duration d) {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(d).count());
+    }
+
+    void answer(Connection& connection, ProofResponse& response, Clock::time_point received) {
+        response.total_us = microseconds(Clock::now() - received);
+        if (response.status == JobStatus::Ok) {
+            completed_count++;
+        } else if (response.status == JobStatus::Busy) {
+            rejected_count++;
+        } else {
+            failed_count++;
+        }
+        connection.send(response);
+    }
+
+    // Ok if queued; Busy or ShuttingDown otherwise
+    JobStatus enqueue(Job&& job) {
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex);
+            if (queue_closed) return JobStatus::ShuttingDown;
+            if (queue.size() >= options.queue_capacity) return JobStatus::Busy;
+            queue.push_back(std::move(job));
+        }
+        queue_ready.notify_one();
+        return JobStatus::Ok;
+    }
+
+    // Ok if the circuit takes `count` values for this kind of job
+    JobStatus admit(const ProofRequest& request, size_t count) const {
+        auto found = circuits.find(request.circuit_id);
+        if (found == circuits.end()) return JobStatus::UnknownCircuit;
+        const Circuit& circuit = found->second;
+        if (request.kind == JobKind::Witness) {
+            return count == static_cast<size_t>(circuit.qap.num_variables)
+                ? JobStatus::Ok : JobStatus::InvalidWitness;
+        }
+        if (request.kind == JobKind::Inputs) {
+            if (!circuit.generate) return JobStatus::BadRequest;
+            return count == circuit.input_count ? JobStatus::Ok : JobStatus::InvalidWitness;
+        }
+        return JobStatus::BadRequest;
+    }
+
+    void readerLoop(std::shared_ptr<Connection> connection, std::shared_ptr<std::atomic<bool>> finished) {
+        using namespace prover_protocol;
+        unsigned char header[REQUEST_HEADER_BYTES];
+        std::vector<unsigned char> payload;
+        while (readFully(connection->fd, header, sizeof(header))) {
+            Job job;
+            job.request.kind = static_cast<JobKind>(getU32(header + 4));
+            job.request.job_id = getU64(header + 8);
+            job.request.circuit_id = getU32(header + 16);
+            size_t count = getU32(header + 20);
+
+            ProofResponse response;
+            response.job_id = job.request.job_id;
+            if (getU32(header) != REQUEST_MAGIC) {
+                // The stream cannot be resynchronised: answer and hang up
+                response.status = JobStatus::BadRequest;
+                answer(*connection, response, Clock::now());
+                break;
+            }
+            JobStatus admitted = admit(job.request, count);
+            if (admitted != JobStatus::Ok) {
+                response.status = admitted;
+                answer(*connection, response, Clock::now());
+                if (count > options.max_values || !skipFully(connection->fd, 4 * count)) break;
+                continue;
+            }
+            payload.resize(4 * count);
+            if (!readFully(connection->fd, payload.data(), payload.size())) break;
+            job.received = Clock::now();
+
+            bool values_ok = true;
+            job.request.values.resize(count);
+            for (size_t i = 0; i < count; i++) {
+                uint32_t v = getU32(payload.data() + 4 * i);
+                values_ok = values_ok && v < FieldElement::getPrime();
+                job.request.values[i] = FieldElement(v);
+            }
+            if (!values_ok) {
+                response.status = JobStatus::BadRequest;
+                answer(*connection, response, job.received);
+                continue;
+            }
+
+            job.connection = connection;
+            Clock::time_point received = job.received;
+            JobStatus status = enqueue(std::move(job));
+            if (status != JobStatus::Ok) {
+                response.status = status;
+                answer(*connection, response, received);
+            }
+        }
+        connection.reset();
+        *finished = true;
+    }
+
+    ProofResponse run(const Job& job) {
+        ProofResponse response;
+        response.job_id = job.request.job_id;
+        auto found = circuits.find(job.request.circuit_id);
+        if (found == circuits.end()) {
+            response.status = JobStatus::UnknownCircuit;
+            return response;
+        }
+        const Circuit& circuit = found->second;
+        try {
+            std::vector<FieldElement> witness;
+            if (job.request.kind == JobKind::Inputs) {
+                if (!circuit.generate) {
+                    response.status = JobStatus::BadRequest;
+                    return response;
+                }
+                witness = circuit.generate(job.request.values);
+            } else {
+                witness = job.request.values;
+            }
+            if (witness.size() != static_cast<size_t>(circuit.qap.num_variables)) {
+                response.status = JobStatus::InvalidWitness;
+                return response;
+            }
+            // The prover checks the witness against the QAP itself
+            response.proof = circuit.mapped_key
+                ? zkSNARK::prove(circuit.qap, *circuit.mapped_key, witness, {})
+                : zkSNARK::prove(circuit.qap, circuit.key, witness, {});
+            response.status = JobStatus::Ok;
+        } catch (const InvalidWitnessError&) {
+            response.status = JobStatus::InvalidWitness;
+        } catch (const std::exception&) {
+            response.status = JobStatus::InternalError;
+        }
+        return response;
+    }
+
+    void workerLoop() {
+        while (true) {
+            Job job;
+            {
+                std::unique_lock<std::mutex> lock(queue_mutex);
+                queue_ready.wait(lock, [this]() { return queue_closed || !queue.empty(); });
+                if (queue.empty()) return; // closed and drained
+                job = std::move(queue.front());
+                queue.pop_front();
+            }
+            Clock::time_point started = Clock::now();
+            ProofResponse response = run(job);
+            response.queue_us = microseconds(started - job.received);
+            response.prove_us = microseconds(Clock::now() - started);
+            answer(*job.connection, response, job.received);
+        }
+    }
+
+    void reapReaders() {
+        for (size_t i = 0; i < readers.size();) {
+            if (*readers[i].finished) {
+                readers[i].thread.join();
+                readers[i] = std::move(readers.back());
+                readers.pop_back();
+            } else {
+                i++;
+            }
+        }
+    }
+
+    void acceptLoop() {
+        pollfd fds[2];
+        fds[0].fd = listen_fd;
+        fds[0].events = POLLIN;
+        fds[1].fd = wake_pipe[0];
+        fds[1].events = POLLIN;
+        while (true) {
+            fds[0].revents = 0;
+            fds[1].revents = 0;
+            if (::poll(fds, 2, -1) < 0) {
+                if (errno == EINTR) continue;
+                return;
+            }
+            if (fds[1].revents != 0) return; // drain requested
+            if ((fds[0].revents & POLLIN) == 0) continue;
+
+            int fd = ::accept(listen_fd, nullptr, nullptr);
+            if (fd < 0) continue;
+            reapReaders();
+            if (readers.size() >= options.max_connections) {
+                ::close(fd); // connection-level backpressure
+                continue;
+            }
+            if (options.send_timeout_ms > 0) {
+                timeval timeout;
+                timeout.tv_sec = options.send_timeout_ms / 1000;
+                timeout.tv_usec = (options.send_timeout_ms % 1000) * 1000;
+                ::setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+            }
+            connections_count++;
+            std::shared_ptr<Connection> connection = std::make_shared<Connection>(fd);
+            ReaderThread reader;
+            reader.connection = connection;
+            reader.finished = std::make_shared<std::atomic<bool>>(false);
+            std::shared_ptr<std::atomic<bool>> finished = reader.finished;
+            reader.thread = std::thread([this, connection, finished]() mutable {
+                readerLoop(std::move(connection), std::move(finished));
+            });
+            connection.reset();
+            readers.push_back(std::move(reader));
+        }
+    }
+
+public:
+    explicit ProverServer(const std::string& path, const ProverServerOptions& opts = ProverServerOptions())
+        : socket_path(path), options(opts) {
+        options.workers = std::max<size_t>(options.workers, 1);
+        options.queue_capacity = std::max<size_t>(options.queue_capacity, 1);
+    }
+
+    ~ProverServer() {
+        if (running) drain();
+    }
+
+    ProverServer(const ProverServer&) = delete;
+    ProverServer& operator=(const ProverServer&) = delete;
+
+    // Register circuits before start(). Inputs jobs must carry exactly
+    // input_count values, the number the generator takes.
+    void addCircuit(uint32_t id, QAP qap, ProvingKey key, WitnessGenerator generate = nullptr,
+                    size_t input_count = 0) {
+        if (running) throw std::runtime_error("Circuits must be added before the server starts");
+        Circuit& circuit = circuits[id];
+        circuit.qap = std::move(qap);
+        circuit.key = std::move(key);
+        circuit.mapped_key.reset();
+        circuit.generate = std::move(generate);
+        circuit.input_count = input_count;
+    }
+
+    // Circuit whose proving key is used in place from a key file
+    void addCircuit(uint32_t id, QAP qap, std::unique_ptr<MappedProvingKey> key,
+                    WitnessGenerator generate = nullptr, size_t input_count = 0) {
+        if (running) throw std::runtime_error("Circuits must be added before the server starts");
+        Circuit& circuit = circuits[id];
+        circuit.qap = std::move(qap);
+        circuit.key = ProvingKey();
+        circuit.mapped_key = std::move(key);
+        circuit.generate = std::move(generate);
+        circuit.input_count = input_count;
+    }
+
+    // Bind the socket and start accepting jobs
+    void start() {
+        using namespace prover_protocol;
+        if (running) return;
+        sockaddr_un address = socketAddress(socket_path);
+
+        // A socket file left by a server that died is removed; a live one
+        // is not taken over
+        int probe = connectTo(socket_path);
+        if (probe >= 0) {
+            ::close(probe);
+            throw std::runtime_error("A prover server is already listening on " + socket_path);
+        }
+        ::unlink(socket_path.c_str());
+
+        listen_fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listen_fd < 0 ||
+            ::bind(listen_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+            ::listen(listen_fd, 64) != 0) {
+            if (listen_fd >= 0) ::close(listen_fd);
+            listen_fd = -1;
+            throw std::runtime_error("Cannot listen on " + socket_path);
+        }
+        if (::pipe(wake_pipe) != 0) {
+            ::close(listen_fd);
+            listen_fd = -1;
+            throw std::runtime_error("Cannot create the server wake-up pipe");
+        }
+
+        queue_closed = false;
+        running = true;
+        for (size_t i = 0; i < options.workers; i++) {
+            workers.emplace_back([this]() { workerLoop(); });
+        }
+        acceptor = std::thread([this]() { acceptLoop(); });
+    }
+
+    // Ask a running server to drain. Only writes to a pipe, so it may be
+    // called from a signal handler; wait() does the draining.
+    void requestDrain() {
+        if (wake_pipe[1] < 0) return;
+        char byte = 1;
+        ssize_t ignored = ::write(wake_pipe[1], &byte, 1);
+        (void)ignored;
+    }
+
+    // Block until a drain is requested, then drain: stop accepting, answer
+    // every queued job, close all connections
+    void wait() {
+        if (!running) return;
+        acceptor.join();
+        ::close(listen_fd);
+        listen_fd = -1;
+        ::unlink(socket_path.c_str());
+
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex);
+            queue_closed = true;
+        }
+        queue_ready.notify_all();
+        for (std::thread& worker : workers) worker.join();
+        workers.clear();
+
+        for (ReaderThread& reader : readers) {
+            if (std::shared_ptr<Connection> connection = reader.connection.lock()) {
+                ::shutdown(connection->fd, SHUT_RDWR);
+            }
+        }
+        for (ReaderThread& reader : readers) reader.thread.join();
+        readers.clear();
+
+        ::close(wake_pipe[0]);
+        ::close(wake_pipe[1]);
+        wake_pipe[0] = wake_pipe[1] = -1;
+        running = false;
+    }
+
+    void drain() {
+        requestDrain();
+        wait();
+    }
+
+    bool isRunning() const { return running; }
+    const std::string& path() const { return socket_path; }
+
+    size_t queuedJobs() {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        return queue.size();
+    }
+
+    Stats stats() const {
+        Stats s;
+        s.connections = connections_count.load();
+        s.completed = completed_count.load();
+        s.failed = failed_count.load();
+        s.rejected = rejected_count.load();
+        return s;
+    }
+};
+
+// Client side of the protocol. send() and receive() may be interleaved to
+// keep several jobs in flight; prove() is one job, round trip.
+class ProverClient {
+private:
+    int fd;
+
+public:
+    explicit ProverClient(const std::string& path) : fd(prover_protocol::connectTo(path)) {
+        if (fd < 0) {
+            throw std::runtime_error("Cannot connect to the prover server at " + path);
+        }
+    }
+
+    ~ProverClient() { ::close(fd); }
+
+    ProverClient(const ProverClient&) = delete;
+    ProverClient& operator=(const ProverClient&) = delete;
+
+    void send(const ProofRequest& request) {
+        std::vector<unsigned char> frame = prover_protocol::encodeRequest(request);
+        if (!prover_protocol::writeFully(fd, frame.data(), frame.size())) {
+            throw std::runtime_error("Prover server closed the connection");
+        }
+    }
+
+    ProofResponse receive() {
+        unsigned char frame[prover_protocol::RESPONSE_BYTES];
+        if (!prover_protocol::readFully(fd, frame, sizeof(frame))) {
+            throw std::runtime_error("Prover server closed the connection");
+        }
+        return prover_protocol::decodeResponse(frame);
+    }
+
+    ProofResponse prove(const ProofRequest& request) {
+        send(request);
+        return receive();
+    }
+};
+
+#endif // PROVER_SERVER_H
@@ -0,0 +1,553 @@
+#ifndef PROVING_KEY_FILE_H
+#define PROVING_KEY_FILE_H
+
+#include "field.h"
+#include "pairing.h"
+#include "mapped_file.h"
+#include "msm.h"
+#include "parallel.h"
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <stdexcept>
+#include <random>
+#include <atomic>
+#include <cerrno>
+
+// Element queries of a proving key, in file order. All are in G1: the
+// B query also serves as [B_i(tau)]_2 with a symmetric backend (see
+// zksnark.h).
+enum class KeySection : uint32_t { A = 0, B = 1, H = 2, L = 3 };
+constexpr size_t KEY_SECTION_COUNT = 4;
+
+// Fixed elements stored ahead of the queries
+template <typename Pairing>
+struct KeyFixedPoints {
+    typename Pairing::G1 alpha;     // [alpha]_1
+    typename Pairing::G1 beta;      // [beta]_1
+    typename Pairing::G1 delta;     // [delta]_1
+    typename Pairing::G2 beta_g2;   // [beta]_2
+    typename Pairing::G2 delta_g2;  // [delta]_2
+};
+
+// Where one query lives in the file. Element i of the query is the
+// identity unless bit i of the bitmap is set; the set bits' elements are
+// stored in order in their serialised form (G1::toBytes), so the j-th
+// stored element starts at elements_offset + j * g1_bytes. Keys are
+// dominated by identities (variables absent from a matrix), and those take
+// one bit instead of a stored element.
+struct KeySectionInfo {
+    uint64_t count;             // elements in the query, including identities
+    uint64_t present;           // elements stored (set bits of the bitmap)
+    uint64_t bitmap_offset;     // u64[(count + 63) / 64]
+    uint64_t elements_offset;   // u8[present * g1_bytes]
+};
+
+// Header of a proving-key file. All fields are little-endian fixed-width
+// integers and all offsets are from the start of the file; everything
+// after the header is covered by `checksum`.
+//
+// Layout (every array starts on a 64-byte boundary, so a mapping of the
+// file hands out cache-line aligned element arrays):
+//   header
+//   fixed elements               alpha, beta, delta in G1; beta, delta in G2
+//   private variable indices     u32[num_private]
+//   sections A, B, H, L          bitmap, elements each
+struct ProvingKeyFileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t g1_bytes;                          // size of one serialised G1 element
+    uint32_t g2_bytes;                          // size of one serialised G2 element
+    uint64_t num_variables;
+    uint64_t num_private;
+    uint64_t fixed_offset;
+    uint64_t private_offset;
+    KeySectionInfo sections[KEY_SECTION_COUNT];
+    uint64_t payload_bytes;
+    uint64_t checksum;                          // checksum64 of the payload
+};
+
+namespace proving_key_file {
+
+constexpr uint32_t MAGIC = 0x31594B50; // "PKY1"
+constexpr uint32_t VERSION = 3;
+constexpr size_t ALIGNMENT = 64;
+
+inline uint64_t align(uint64_t bytes) { return (bytes + ALIGNMENT - 1) & ~uint64_t(ALIGNMENT - 1); }
+
+inline uint64_t bitmapWords(uint64_t count) { return (count + 63) / 64; }
+
+inline uint64_t popcount64(uint64_t word) {
+    uint64_t bits = 0;
+    for (; word != 0; word &= word - 1) bits++;
+    return bits;
+}
+
+inline uint64_t fixedBytes(const ProvingKeyFileHeader& header) {
+    return 3 * uint64_t(header.g1_bytes) + 2 * uint64_t(header.g2_bytes);
+}
+
+// Place every array of a key with the given section sizes; returns the
+// file size
+inline uint64_t layout(ProvingKeyFileHeader& header) {
+    uint64_t offset = align(sizeof(ProvingKeyFileHeader));
+    header.fixed_offset = offset;
+    offset = align(offset + fixedBytes(header));
+    header.private_offset = offset;
+    offset = align(offset + header.num_private * sizeof(uint32_t));
+    for (KeySectionInfo& s : header.sections) {
+        s.bitmap_offset = offset;
+        offset = align(offset + bitmapWords(s.count) * sizeof(uint64_t));
+        s.elements_offset = offset;
+        offset = align(offset + s.present * header.g1_bytes);
+    }
+    return offset;
+}
+
+} // namespace proving_key_file
+
+// Streams a proving key into a mapped file section by section, so a key
+// never has to be held in memory. The number of stored (non-identity)
+// elements of each section must be known up front to place the arrays;
+// `present` may overestimate it (e.g. a count of nonzero scalars), and
+// the unused tail of the arrays is left zeroed. Sections are appended in
+// file order. The file is written under a unique temporary name and
+// renamed into place by finish(), so concurrent writers and readers of
+// the same path only ever see a complete key.
+template <typename Pairing>
+class ProvingKeyWriter {
+private:
+    using G1 = typename Pairing::G1;
+    using G2 = typename Pairing::G2;
+
+    std::string final_path;
+    std::string staging_path;
+    MappedFile file;
+    ProvingKeyFileHeader header;
+    uint64_t capacity[KEY_SECTION_COUNT];
+    size_t section = 0;
+    uint64_t written = 0;       // elements appended to the current section
+    bool finished = false;
+
+    unsigned char* bytes(uint64_t offset) { return static_cast<unsigned char*>(file.data()) + offset; }
+
+    void skipFilledSections() {
+        while (section < KEY_SECTION_COUNT && written == header.sections[section].count) {
+            section++;
+            written = 0;
+        }
+    }
+
+public:
+    ProvingKeyWriter(const std::string& path, uint64_t num_variables,
+                     const uint64_t (&count)[KEY_SECTION_COUNT],
+                     const uint64_t (&present)[KEY_SECTION_COUNT],
+                     const std::vector<size_t>& private_variables,
+                     const KeyFixedPoints<Pairing>& fixed)
+        : final_path(path), staging_path(path + ".tmp" + std::to_string(std::random_device()())), header{} {
+        using namespace proving_key_file;
+        header.magic = MAGIC;
+        header.version = VERSION;
+        header.g1_bytes = static_cast<uint32_t>(G1::BYTES);
+        header.g2_bytes = static_cast<uint32_t>(G2::BYTES);
+        header.num_variables = num_variables;
+        header.num_private = private_variables.size();
+        for (size_t s = 0; s < KEY_SECTION_COUNT; s++) {
+            if (present[s] > count[s]) {
+                throw std::runtime_error("Proving key section has more stored elements than elements");
+            }
+            header.sections[s].count = count[s];
+            header.sections[s].present = present[s];
+            capacity[s] = present[s];
+        }
+        uint64_t file_bytes = layout(header);
+        header.payload_bytes = file_bytes - sizeof(ProvingKeyFileHeader);
+
+        // The file starts zero-filled: bitmaps need no clearing
+        file = MappedFile::create(staging_path, static_cast<size_t>(file_bytes));
+
+        unsigned char* out = bytes(header.fixed_offset);
+        for (const G1* p : {&fixed.alpha, &fixed.beta, &fixed.delta}) {
+            p->toBytes(out);
+            out += G1::BYTES;
+        }
+        for (const G2* p : {&fixed.beta_g2, &fixed.delta_g2}) {
+            p->toBytes(out);
+            out += G2::BYTES;
+        }
+        uint32_t* indices = reinterpret_cast<uint32_t*>(bytes(header.private_offset));
+        for (size_t i = 0; i < private_variables.size(); i++) {
+            indices[i] = static_cast<uint32_t>(private_variables[i]);
+        }
+        for (KeySectionInfo& s : header.sections) {
+            s.present = 0; // counted again as elements arrive
+        }
+        skipFilledSections();
+    }
+
+    ~ProvingKeyWriter() {
+        if (!finished) {
+            file.close();
+            std::remove(staging_path.c_str());
+        }
+    }
+
+    ProvingKeyWriter(const ProvingKeyWriter&) = delete;
+    ProvingKeyWriter& operator=(const ProvingKeyWriter&) = delete;
+
+    // Next `count` elements of the current section (possibly spilling into
+    // the following ones); identities only set no bit
+    void append(const G1* points, size_t count) {
+        while (count > 0) {
+            if (section == KEY_SECTION_COUNT) {
+                throw std::runtime_error("More proving key elements than declared");
+            }
+            KeySectionInfo& info = header.sections[section];
+            uint64_t* bitmap = reinterpret_cast<uint64_t*>(bytes(info.bitmap_offset));
+            unsigned char* elements = bytes(info.elements_offset);
+            size_t take = static_cast<size_t>(std::min<uint64_t>(count, info.count - written));
+            for (size_t i = 0; i < take; i++) {
+                if (points[i].isIdentity()) continue;
+                if (info.present == capacity[section]) {
+                    throw std::runtime_error("More stored proving key elements than declared");
+                }
+                uint64_t index = written + i;
+                bitmap[index / 64] |= uint64_t(1) << (index % 64);
+                points[i].toBytes(elements + info.present * G1::BYTES);
+                info.present++;
+            }
+            points += take;
+            count -= take;
+            written += take;
+            skipFilledSections();
+        }
+    }
+
+    // Index of the section the next element goes to
+    KeySection currentSection() const { return static_cast<KeySection>(section); }
+
+    void finish() {
+        if (section != KEY_SECTION_COUNT) {
+            throw std::runtime_error("Proving key is missing elements");
+        }
+        header.checksum = checksum64(bytes(sizeof(header)), static_cast<size_t>(header.payload_bytes));
+        std::memcpy(bytes(0), &header, sizeof(header));
+        file.flush();
+        file.close();
+        // rename replaces the old key atomically; Windows needs it gone first
+#ifdef _WIN32
+        std::remove(final_path.c_str());
+#endif
+        if (std::rename(staging_path.c_str(), final_path.c_str()) != 0) {
+            std::remove(staging_path.c_str());
+            finished = true;
+            throw std::runtime_error("Cannot publish proving key " + final_path);
+        }
+        finished = true;
+    }
+};
+
+// One query of a mapped proving key: the bitmap and element array point
+// straight into the mapping
+template <typename G>
+struct QueryView {
+    uint64_t count = 0;
+    uint64_t present = 0;
+    const uint64_t* bitmap = nullptr;
+    const unsigned char* elements = nullptr;
+
+    bool isStored(size_t i) const { return (bitmap[i / 64] >> (i % 64)) & 1; }
+
+    // j-th stored element
+    G stored(size_t j) const { return G::fromBytes(elements + j * G::BYTES); }
+
+    // The stored elements, as an MSM base source
+    G operator[](size_t j) const { return stored(j); }
+
+    // All `count` elements, identities included
+    std::vector<G> toVector() const {
+        std::vector<G> points(count);
+        size_t j = 0;
+        for (size_t i = 0; i < count; i++) {
+            if (isStored(i)) {
+                if (j == present) {
+                    throw std::runtime_error("Proving key bitmap does not match its element count");
+                }
+                points[i] = stored(j++);
+            }
+        }
+        return points;
+    }
+};
+
+// sum_i scalars[i] * P_i over a mapped query. Identities carry no scalar:
+// the scalars of the stored elements are gathered in bitmap order and the
+// element array goes to the MSM as it lies in the file.
+template <typename G>
+G msm(const QueryView<G>& bases, const std::vector<FieldElement>& scalars) {
+    if (scalars.size() > bases.count) {
+        throw std::runtime_error("MSM has more scalars than bases");
+    }
+    std::vector<FieldElement> gathered;
+    gathered.reserve(static_cast<size_t>(bases.present));
+    size_t words = static_cast<size_t>(proving_key_file::bitmapWords(scalars.size()));
+    for (size_t k = 0; k < words; k++) {
+        uint64_t bits = bases.bitmap[k];
+        for (size_t b = 0; bits != 0; b++, bits >>= 1) {
+            if ((bits & 1) == 0) continue;
+            size_t i = 64 * k + b;
+            if (i >= scalars.size()) break;
+            if (gathered.size() == bases.present) {
+                throw std::runtime_error("Proving key bitmap does not match its element count");
+            }
+            gathered.push_back(scalars[i]);
+        }
+    }
+    return msmAccumulate<G>(bases, gathered.data(), gathered.size());
+}
+
+// Proving key used in place from a mapped file. Opening validates the
+// header and the placement of every array, then makes one parallel pass
+// over the sections: each bitmap must hold exactly `present` bits and
+// every stored element must be the canonical encoding of a non-identity
+// group element, as the writer produces them. Bad keys are refused up
+// front instead of surfacing as wrong proofs. The pass also faults the
+// key in. The payload checksum is a second O(size) pass, run on request.
+//
+// The mapping is shared and read-only, so every prover process on a host
+// that maps the same file uses one physical copy of the key. openShared
+// places that copy in memory-backed storage (tmpfs, or hugetlbfs for
+// explicit huge pages) and lets each process attach to it.
+template <typename Pairing>
+class Groth16MappedProvingKey {
+public:
+    using Backend = Pairing;
+    using G1 = typename Pairing::G1;
+    using G2 = typename Pairing::G2;
+
+private:
+    MappedFile file;
+    ProvingKeyFileHeader header;
+
+    const char* bytes(uint64_t offset) const { return static_cast<const char*>(file.data()) + offset; }
+
+    void validate() const {
+        using namespace proving_key_file;
+        uint64_t size = sizeof(header) + header.payload_bytes;
+        auto fits = [&](uint64_t offset, uint64_t items, uint64_t item_bytes) {
+            return offset % ALIGNMENT == 0 && offset <= size && items <= (size - offset) / item_bytes;
+        };
+        if (!fits(header.fixed_offset, 1, fixedBytes(header)) ||
+            !fits(header.private_offset, header.num_private, sizeof(uint32_t)) ||
+            header.num_private > header.num_variables) {
+            throw std::runtime_error("Proving key has inconsistent section offsets");
+        }
+        for (const KeySectionInfo& s : header.sections) {
+            if (s.present > s.count ||
+                !fits(s.bitmap_offset, bitmapWords(s.count), sizeof(uint64_t)) ||
+                !fits(s.elements_offset, s.present, header.g1_bytes)) {
+                throw std::runtime_error("Proving key has inconsistent section offsets");
+            }
+        }
+        const KeySectionInfo* sections = header.sections;
+        if (sections[static_cast<size_t>(KeySection::A)].count != header.num_variables ||
+            sections[static_cast<size_t>(KeySection::B)].count != header.num_variables ||
+            sections[static_cast<size_t>(KeySection::L)].count != header.num_private) {
+            throw std::runtime_error("Proving key sections do not match its variable counts");
+        }
+    }
+
+    // Whether `in` is the encoding toBytes gives for the element it decodes to
+    template <typename G>
+    static bool canonical(const unsigned char* in, bool allow_identity) {
+        G point = G::fromBytes(in);
+        unsigned char round_trip[G::BYTES];
+        point.toBytes(round_trip);
+        return (allow_identity || !point.isIdentity()) && std::memcmp(round_trip, in, G::BYTES) == 0;
+    }
+
+    void validateSections() const {
+        using namespace proving_key_file;
+        const unsigned char* fixed = reinterpret_cast<const unsigned char*>(bytes(header.fixed_offset));
+        for (size_t i = 0; i < 3; i++) {
+            if (!canonical<G1>(fixed + i * G1::BYTES, true)) {
+                throw std::runtime_error("Proving key holds a non-canonical element");
+            }
+        }
+        for (size_t i = 0; i < 2; i++) {
+            if (!canonical<G2>(fixed + 3 * G1::BYTES + i * G2::BYTES, true)) {
+                throw std::runtime_error("Proving key holds a non-canonical element");
+            }
+        }
+
+        for (const KeySectionInfo& info : header.sections) {
+            const uint64_t* bitmap = reinterpret_cast<const uint64_t*>(bytes(info.bitmap_offset));
+            size_t words = static_cast<size_t>(bitmapWords(info.count));
+            uint64_t bits = 0;
+            for (size_t w = 0; w < words; w++) bits += popcount64(bitmap[w]);
+            bool tail_clear = info.count % 64 == 0 || (bitmap[words - 1] >> (info.count % 64)) == 0;
+            if (bits != info.present || !tail_clear) {
+                throw std::runtime_error("Proving key bitmap does not match its element count");
+            }
+
+            const unsigned char* elements = reinterpret_cast<const unsigned char*>(bytes(info.elements_offset));
+            std::atomic<bool> all_canonical(true);
+            parallelFor(0, static_cast<size_t>(info.present), 1 << 14, [&](size_t lo, size_t hi) {
+                for (size_t j = lo; j < hi; j++) {
+                    if (!canonical<G1>(elements + j * G1::BYTES, false)) {
+                        all_canonical = false;
+                        return;
+                    }
+                }
+            });
+            if (!all_canonical) {
+                throw std::runtime_error("Proving key holds a non-canonical element");
+            }
+        }
+    }
+
+public:
+    explicit Groth16MappedProvingKey(const std::string& path, bool verify_checksum = false,
+                              const MapOptions& options = MapOptions())
+        : file(MappedFile::open(path, MappedFile::Mode::ReadOnly, options)) {
+        using namespace proving_key_file;
+        if (file.size() < sizeof(ProvingKeyFileHeader)) {
+            throw std::runtime_error("Proving key is truncated");
+        }
+        std::memcpy(&header, file.data(), sizeof(header));
+        if (header.magic != MAGIC || header.version != VERSION) {
+            throw std::runtime_error("Not a proving key (or an unsupported version)");
+        }
+        if (header.g1_bytes != G1::BYTES || header.g2_bytes != G2::BYTES) {
+            throw std::runtime_error("Proving key was written for a different pairing backend");
+        }
+        // Copies on hugetlbfs are padded to a whole number of huge pages
+        if (header.payload_bytes > file.size() - sizeof(header)) {
+            throw std::runtime_error("Proving key is truncated");
+        }
+        validate();
+        validateSections();
+        if (verify_checksum && !checksumMatches()) {
+            throw std::runtime_error("Proving key failed its checksum");
+        }
+    }
+
+    // Map the host-wide shared copy of the key at `path`, kept at
+    // `shared_path` (e.g. under /dev/shm, or a hugetlbfs mount such as
+    // /dev/hugepages with HugePages::Explicit). The first caller checks
+    // the source against its checksum and publishes the copy atomically;
+    // later callers, in any process, find a copy with the source's
+    // checksum and map it as is.
+    static Groth16MappedProvingKey openShared(const std::string& path, const std::string& shared_path,
+                                       const MapOptions& options = MapOptions()) {
+        Groth16MappedProvingKey source(path);
+        try {
+            Groth16MappedProvingKey shared(shared_path, false, options);
+            if (shared.header.checksum == source.header.checksum &&
+                shared.header.payload_bytes == source.header.payload_bytes) {
+                return shared;
+            }
+        } catch (const std::runtime_error&) {
+            // Missing or stale: publish a fresh copy below
+        }
+        if (!source.checksumMatches()) {
+            throw std::runtime_error("Proving key failed its checksum");
+        }
+
+        // Unique staging name: concurrent publishers never share a file
+        std::string staging = shared_path + ".tmp" + std::to_string(std::random_device()());
+        {
+            // The copy gets the final page backing: transparent huge page
+            // advice has to be given before the memcpy faults the pages in
+            MapOptions staging_options;
+            staging_options.huge_pages = options.huge_pages;
+            MappedFile copy = MappedFile::create(staging, source.file.size(), false, staging_options);
+            std::memcpy(copy.data(), source.file.data(), source.file.size());
+            copy.flush();
+        }
+
+        // Publish without replacing: when another process got there first,
+        // its copy is the one every process maps
+#ifdef _WIN32
+        bool published = std::rename(staging.c_str(), shared_path.c_str()) == 0;
+#else
+        bool published = ::link(staging.c_str(), shared_path.c_str()) == 0;
+        if (!published && errno != EEXIST) {
+            std::remove(staging.c_str());
+            throw std::runtime_error("Cannot publish shared proving key " + shared_path);
+        }
+        if (published) std::remove(staging.c_str());
+#endif
+        if (!published) {
+            try {
+                Groth16MappedProvingKey winner(shared_path, false, options);
+                if (winner.header.checksum == source.header.checksum &&
+                    winner.header.payload_bytes == source.header.payload_bytes) {
+                    std::remove(staging.c_str());
+                    return winner;
+                }
+            } catch (const std::runtime_error&) {
+                // Unreadable: replaced below like a stale copy
+            }
+            // A stale copy is in the way: replace it
+#ifdef _WIN32
+            std::remove(shared_path.c_str());
+#endif
+            if (std::rename(staging.c_str(), shared_path.c_str()) != 0) {
+                std::remove(staging.c_str());
+                throw std::runtime_error("Cannot publish shared proving key " + shared_path);
+            }
+        }
+        return Groth16MappedProvingKey(shared_path, false, options);
+    }
+
+    const ProvingKeyFileHeader& info() const { return header; }
+
+    // Bytes of the mapping (the key file, plus any huge-page padding)
+    size_t mappedBytes() const { return file.size(); }
+
+    bool checksumMatches() const {
+        file.prefetch(sizeof(header), static_cast<size_t>(header.payload_bytes));
+        return checksum64(bytes(sizeof(header)), static_cast<size_t>(header.payload_bytes)) == header.checksum;
+    }
+
+    KeyFixedPoints<Pairing> fixedPoints() const {
+        const unsigned char* in = reinterpret_cast<const unsigned char*>(bytes(header.fixed_offset));
+        KeyFixedPoints<Pairing> fixed;
+        fixed.alpha = G1::fromBytes(in);
+        fixed.beta = G1::fromBytes(in + G1::BYTES);
+        fixed.delta = G1::fromBytes(in + 2 * G1::BYTES);
+        fixed.beta_g2 = G2::fromBytes(in + 3 * G1::BYTES);
+        fixed.delta_g2 = G2::fromBytes(in + 3 * G1::BYTES + G2::BYTES);
+        return fixed;
+    }
+
+    std::vector<size_t> privateVariables() const {
+        const uint32_t* in = reinterpret_cast<const uint32_t*>(bytes(header.private_offset));
+        std::vector<size_t> indices(static_cast<size_t>(header.num_private));
+        for (size_t i = 0; i < indices.size(); i++) {
+            indices[i] = in[i];
+            if (indices[i] >= header.num_variables) {
+                throw std::runtime_error("Proving key has an out-of-range private variable");
+            }
+        }
+        return indices;
+    }
+
+    QueryView<G1> section(KeySection s) const {
+        const KeySectionInfo& info = header.sections[static_cast<size_t>(s)];
+        QueryView<G1> view;
+        view.count = info.count;
+        view.present = info.present;
+        view.bitmap = reinterpret_cast<const uint64_t*>(bytes(info.bitmap_offset));
+        view.elements = reinterpret_cast<const unsigned char*>(bytes(info.elements_offset));
+        return view;
+    }
+};
+
+using MappedProvingKey = Groth16MappedProvingKey<ToyPairing>;
+
+#endif // PROVING_KEY_FILE_H
@@ -3,200 +3,463 @@
 
 #include "field.h"
 #include "r1cs.h"
+#include "polynomial.h"
+#include "domain.h"
+#include "arena.h"
+#include "parallel.h"
+#include "gemm.h"
 #include <vector>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <random>
+#include <stdexcept>
 
-// Polynomial representation
-class Polynomial {
+// Non-zero entry of an R1CS column: constraint `row` has coefficient `value`
+struct SparseEntry {
+    uint32_t row;
+    FieldElement value;
+};
+
+// One variable's column of an R1CS matrix. In the Lagrange basis of the
+// evaluation domain this *is* the QAP polynomial:
+//   A_i(x) = sum over entries of value * L_row(x)
+using SparseColumn = std::vector<SparseEntry>;
+
+// QAP: Quadratic Arithmetic Program
+//
+// The per-variable polynomials are stored in Lagrange form as sparse columns,
+// so the QAP takes O(nnz) memory instead of O(n * m). Coefficient form is
+// interpolated lazily, only when a caller asks for it.
+class QAP {
 public:
-    std::vector<FieldElement> coefficients; // coefficients[i] is the coefficient of x^i
+    enum class Matrix { A = 0, B = 1, C = 2 };
     
-    Polynomial() {}
-    Polynomial(const std::vector<FieldElement>& coeffs) : coefficients(coeffs) {}
+    std::vector<SparseColumn> A_columns;
+    std::vector<SparseColumn> B_columns;
+    std::vector<SparseColumn> C_columns;
+    EvaluationDomain domain; // Points at which the constraints are placed
+    int num_variables = 0;
+    int num_constraints = 0;
     
-    // Evaluate polynomial at point x
-    FieldElement evaluate(const FieldElement& x) const {
-        FieldElement result(0);
-        FieldElement x_power(1);
-        
-        for (const auto& coeff : coefficients) {
-            result = result + coeff * x_power;
-            x_power = x_power * x;
-        }
-        
-        return result;
+private:
+    // Coefficient-form polynomials, filled on first use. Shared between
+    // copies of the same QAP. A fill is computed outside any lock and
+    // published once under `publish`; no lock is held while interpolating,
+    // because a thread waiting on its parallel loop runs other queued tasks
+    // and may re-enter the fill of the same matrix. Racing first users may
+    // both interpolate; the first to publish wins.
+    struct CoefficientCache {
+        std::mutex publish;
+        std::vector<Polynomial> polys[3];
+        std::atomic<bool> ready[3] = {{false}, {false}, {false}};
+    };
+
+    // Install a filled matrix unless one is already there. Once ready, a
+    // matrix's polynomials are never written again.
+    void publishCoefficients(int idx, std::vector<Polynomial>&& polys) const {
+        std::lock_guard<std::mutex> lock(cache->publish);
+        if (cache->ready[idx].load(std::memory_order_acquire)) return;
+        cache->polys[idx] = std::move(polys);
+        cache->ready[idx].store(true, std::memory_order_release);
     }
+    std::shared_ptr<CoefficientCache> cache = std::make_shared<CoefficientCache>();
     
-    // Add polynomials
-    Polynomial operator+(const Polynomial& other) const {
-        int max_size = std::max(coefficients.size(), other.coefficients.size());
-        std::vector<FieldElement> result_coeffs(max_size, FieldElement(0));
+public:
+    // Convert R1CS to QAP over the smallest multiplicative subgroup that
+    // holds all constraints (Z(x) = x^N - 1)
+    static QAP fromR1CS(const R1CS& r1cs) {
+        return fromR1CS(r1cs, EvaluationDomain::subgroup(r1cs.num_constraints));
+    }
+    
+    // Convert R1CS to QAP over the given domain; constraint i is placed at
+    // domain.element(i). Only the non-zero column entries are kept.
+    static QAP fromR1CS(const R1CS& r1cs, const EvaluationDomain& domain) {
+        std::cout << "\n=== Converting R1CS to QAP ===" << std::endl;
         
-        for (size_t i = 0; i < coefficients.size(); i++) {
-            result_coeffs[i] = result_coeffs[i] + coefficients[i];
-        }
-        for (size_t i = 0; i < other.coefficients.size(); i++) {
-            result_coeffs[i] = result_coeffs[i] + other.coefficients[i];
+        if (domain.size() < static_cast<size_t>(r1cs.num_constraints)) {
+            throw std::runtime_error("Evaluation domain is smaller than the number of constraints");
         }
         
-        return Polynomial(result_coeffs);
-    }
-    
-    // Multiply polynomials
-    Polynomial operator*(const Polynomial& other) const {
-        if (coefficients.empty() || other.coefficients.empty()) {
-            return Polynomial();
+        QAP qap;
+        qap.num_variables = r1cs.num_variables;
+        qap.num_constraints = r1cs.num_constraints;
+        qap.domain = domain;
+        
+        std::cout << "Evaluation domain: ";
+        domain.print();
+        std::cout << std::endl;
+        
+        std::cout << "Evaluation points: ";
+        for (int i = 0; i < r1cs.num_constraints; i++) {
+            std::cout << domain.element(i) << " ";
         }
+        std::cout << std::endl;
         
-        std::vector<FieldElement> result_coeffs(
-            coefficients.size() + other.coefficients.size() - 1, 
-            FieldElement(0)
-        );
+        qap.A_columns.resize(r1cs.num_variables);
+        qap.B_columns.resize(r1cs.num_variables);
+        qap.C_columns.resize(r1cs.num_variables);
         
-        for (size_t i = 0; i < coefficients.size(); i++) {
-            for (size_t j = 0; j < other.coefficients.size(); j++) {
-                result_coeffs[i + j] = result_coeffs[i + j] + coefficients[i] * other.coefficients[j];
+        // For each variable and matrix, collect the constraints it takes part
+        // in. The 3 * n columns are independent and each task writes only its
+        // own column, so the result does not depend on scheduling.
+        // Domain points past the last constraint carry the trivial 0 * 0 = 0.
+        size_t n = static_cast<size_t>(r1cs.num_variables);
+        parallelFor(0, 3 * n, 16, [&](size_t lo, size_t hi) {
+            for (size_t item = lo; item < hi; item++) {
+                Matrix m = static_cast<Matrix>(item / n);
+                size_t var = item % n;
+                const std::vector<std::vector<FieldElement>>& source =
+                    (m == Matrix::A) ? r1cs.A : (m == Matrix::B) ? r1cs.B : r1cs.C;
+                SparseColumn& column = (m == Matrix::A) ? qap.A_columns[var]
+                                     : (m == Matrix::B) ? qap.B_columns[var] : qap.C_columns[var];
+                
+                for (int constraint = 0; constraint < r1cs.num_constraints; constraint++) {
+                    const FieldElement& value = source[constraint][var];
+                    if (value != FieldElement(0)) {
+                        column.push_back({static_cast<uint32_t>(constraint), value});
+                    }
+                }
             }
-        }
+        });
+        
+        std::cout << "Extracted sparse columns for " << r1cs.num_variables << " variables" << std::endl;
+        
+        // Target polynomial vanishes on the whole domain
+        std::cout << "Target polynomial Z(x) = ";
+        domain.sparseVanishing().print();
+        std::cout << std::endl;
+        std::cout << "Non-zero entries: " << qap.nonZeroCount() << std::endl;
         
-        return Polynomial(result_coeffs);
+        return qap;
     }
     
-    // Scalar multiplication
-    Polynomial operator*(const FieldElement& scalar) const {
-        std::vector<FieldElement> result_coeffs(coefficients.size());
-        for (size_t i = 0; i < coefficients.size(); i++) {
-            result_coeffs[i] = coefficients[i] * scalar;
+    const std::vector<SparseColumn>& columns(Matrix m) const {
+        switch (m) {
+            case Matrix::A: return A_columns;
+            case Matrix::B: return B_columns;
+            default:        return C_columns;
         }
-        return Polynomial(result_coeffs);
     }
     
-    void print() const {
-        std::cout << "[";
-        for (size_t i = 0; i < coefficients.size(); i++) {
-            std::cout << coefficients[i];
-            if (i < coefficients.size() - 1) std::cout << ", ";
+    size_t nonZeroCount() const {
+        size_t count = 0;
+        for (int var = 0; var < num_variables; var++) {
+            count += A_columns[var].size() + B_columns[var].size() + C_columns[var].size();
         }
-        std::cout << "]";
+        return count;
     }
-};
-
-// Lagrange interpolation for creating polynomials
-class LagrangeInterpolation {
-public:
-    // Create Lagrange basis polynomial L_j(x) that is 1 at x_j and 0 at all other x_i
-    static Polynomial basisPolynomial(int j, const std::vector<FieldElement>& x_values) {
-        Polynomial result({FieldElement(1)});
-        
-        for (size_t i = 0; i < x_values.size(); i++) {
-            if (i == j) continue;
-            
-            // Multiply by (x - x_i) / (x_j - x_i)
-            FieldElement denominator = x_values[j] - x_values[i];
-            
-            // (x - x_i) represented as [-x_i, 1]
-            Polynomial numerator({FieldElement(0) - x_values[i], FieldElement(1)});
-            
-            result = result * numerator;
-            result = result * (FieldElement(1) / denominator);
+    
+    // Target polynomial Z(x), vanishing on the whole domain. Kept by the
+    // domain (as x^N - g^N for subgroups and cosets), not copied here.
+    Polynomial targetPolynomial() const { return domain.vanishingPolynomial(); }
+    
+    // Coefficient form of every variable's polynomial for one matrix,
+    // interpolated over the domain on first use. Variables are interpolated
+    // in parallel: each chunk reuses one value buffer, the NTT temporaries
+    // come from the running thread's own scratch arena, and every task
+    // writes only its own slots of the output.
+    const std::vector<Polynomial>& coefficientPolynomials(Matrix m) const {
+        int idx = static_cast<int>(m);
+        if (cache->ready[idx].load(std::memory_order_acquire)) {
+            return cache->polys[idx];
         }
+        const std::vector<SparseColumn>& cols = columns(m);
+        std::vector<Polynomial> polys(num_variables);
         
+        parallelFor(0, num_variables, 1, [&](size_t lo, size_t hi) {
+            std::vector<FieldElement> values(num_constraints);
+            for (size_t var = lo; var < hi; var++) {
+                std::fill(values.begin(), values.end(), FieldElement(0));
+                for (const SparseEntry& entry : cols[var]) {
+                    values[entry.row] = entry.value;
+                }
+                polys[var] = domain.interpolate(values);
+            }
+        });
+        publishCoefficients(idx, std::move(polys));
+        return cache->polys[idx];
+    }
+    
+    // Interpolate the coefficient form of A, B and C at once
+    void precomputeCoefficients() const {
+        parallelFor(0, 3, 1, [&](size_t lo, size_t hi) {
+            for (size_t m = lo; m < hi; m++) {
+                coefficientPolynomials(static_cast<Matrix>(m));
+            }
+        });
+    }
+    
+    // Whether the coefficient form of one matrix has been filled
+    bool hasCoefficientPolynomials(Matrix m) const {
+        return cache->ready[static_cast<int>(m)];
+    }
+    
+    // Coefficient form of a single variable's polynomial
+    const Polynomial& polynomial(Matrix m, int var) const {
+        return coefficientPolynomials(m)[var];
+    }
+    
+    // Install coefficient form computed elsewhere (e.g. loaded from disk).
+    // Has no effect if that matrix's polynomials were already filled.
+    void setCoefficientPolynomials(Matrix m, std::vector<Polynomial>&& polys) const {
+        publishCoefficients(static_cast<int>(m), std::move(polys));
+    }
+
+    // P_i(r) for every variable, given the Lagrange basis values
+    // L_0(r), ..., L_{N-1}(r) from domain.lagrangeCoefficients(r): O(nnz)
+    std::vector<FieldElement> evaluateAt(Matrix m, const std::vector<FieldElement>& lagrange) const {
+        const std::vector<SparseColumn>& cols = columns(m);
+        std::vector<FieldElement> result(num_variables, FieldElement(0));
+        parallelFor(0, static_cast<size_t>(num_variables), 1024, [&](size_t lo, size_t hi) {
+            for (size_t var = lo; var < hi; var++) {
+                uint64_t acc = 0;
+                for (const SparseEntry& entry : cols[var]) {
+                    acc += FieldElement::foldProduct(entry.value.getValue() * lagrange[entry.row].getValue());
+                }
+                result[var] = FieldElement(acc);
+            }
+        });
         return result;
     }
     
-    // Interpolate polynomial through points (x_i, y_i)
-    static Polynomial interpolate(const std::vector<FieldElement>& x_values,
-                                  const std::vector<FieldElement>& y_values) {
-        if (x_values.size() != y_values.size()) {
-            throw std::runtime_error("x and y value sizes must match");
-        }
+    // Values of sum_i witness[i] * P_i(x) at the constraint points:
+    // one sparse matrix-vector product, with lazy reduction per row
+    std::vector<FieldElement> evaluateOnDomain(Matrix m, const std::vector<FieldElement>& witness) const {
+        const std::vector<SparseColumn>& cols = columns(m);
         
-        Polynomial result({FieldElement(0)});
+        ArenaScope scope(scratchArena());
+        std::pmr::vector<uint64_t> acc(num_constraints, 0, &scratchArena());
         
-        for (size_t j = 0; j < x_values.size(); j++) {
-            Polynomial basis = basisPolynomial(j, x_values);
-            result = result + basis * y_values[j];
+        for (int var = 0; var < num_variables; var++) {
+            uint64_t w = witness[var].getValue();
+            if (w == 0) continue;
+            for (const SparseEntry& entry : cols[var]) {
+                acc[entry.row] += FieldElement::foldProduct(w * entry.value.getValue());
+            }
         }
         
+        std::vector<FieldElement> result(num_constraints);
+        for (int row = 0; row < num_constraints; row++) {
+            result[row] = FieldElement(acc[row]);
+        }
         return result;
     }
-};
+    
+    // Random point off the domain (Z(r) != 0), for the probabilistic checks
+    FieldElement randomPoint() const {
+        static thread_local std::mt19937_64 gen(std::random_device{}());
+        std::uniform_int_distribution<uint64_t> dis(1, FieldElement::getPrime() - 1);
+        FieldElement r;
+        do {
+            r = FieldElement(dis(gen));
+        } while (domain.evaluateVanishing(r) == FieldElement(0));
+        return r;
+    }
 
-// QAP: Quadratic Arithmetic Program
-class QAP {
-public:
-    std::vector<Polynomial> A_polys;
-    std::vector<Polynomial> B_polys;
-    std::vector<Polynomial> C_polys;
-    Polynomial Z; // Target polynomial
-    int num_variables;
+    // A(r), B(r), C(r) for a witness and, when asked for, T(r) for the
+    // polynomial T taking the constraint residuals a_i * b_i - c_i on the
+    // domain. The domain values come from one sparse pass per matrix and are
+    // combined with the Lagrange basis at r: O(N + nnz), nothing is
+    // interpolated.
+    void evaluateWitnessAt(const std::vector<FieldElement>& witness, const FieldElement& r,
+                           FieldElement at_r[3], FieldElement* residual_at_r = nullptr) const {
+        if (witness.size() < static_cast<size_t>(num_variables)) {
+            throw std::runtime_error("Witness is shorter than the number of QAP variables");
+        }
+        std::vector<FieldElement> lagrange = domain.lagrangeCoefficients(r);
+        std::vector<FieldElement> values[3];
+        parallelFor(0, 3, 1, [&](size_t lo, size_t hi) {
+            for (size_t m = lo; m < hi; m++) {
+                values[m] = evaluateOnDomain(static_cast<Matrix>(m), witness);
+            }
+        });
+
+        // Rows past num_constraints are zero in all three matrices
+        uint64_t acc[3] = {0, 0, 0};
+        uint64_t residual_acc = 0;
+        for (int row = 0; row < num_constraints; row++) {
+            uint64_t l = lagrange[row].getValue();
+            for (int m = 0; m < 3; m++) {
+                acc[m] += FieldElement::foldProduct(l * values[m][row].getValue());
+            }
+            if (residual_at_r) {
+                FieldElement t = values[0][row] * values[1][row] - values[2][row];
+                residual_acc += FieldElement::foldProduct(l * t.getValue());
+            }
+        }
+        for (int m = 0; m < 3; m++) {
+            at_r[m] = FieldElement(acc[m]);
+        }
+        if (residual_at_r) *residual_at_r = FieldElement(residual_acc);
+    }
+
+    // Exact satisfiability check of a witness in O(N + nnz): one sparse
+    // pass per matrix gives a_i, b_i, c_i for every constraint, and each
+    // residual a_i * b_i - c_i must be zero. The witness then satisfies the
+    // QAP (A*B - C vanishes on the domain, so Z divides it). The first
+    // unsatisfied constraint is reported through `unsatisfied`.
+    bool checkWitness(const std::vector<FieldElement>& witness, size_t* unsatisfied = nullptr) const {
+        if (witness.size() < static_cast<size_t>(num_variables)) {
+            throw std::runtime_error("Witness is shorter than the number of QAP variables");
+        }
+        std::vector<FieldElement> values[3];
+        parallelFor(0, 3, 1, [&](size_t lo, size_t hi) {
+            for (size_t m = lo; m < hi; m++) {
+                values[m] = evaluateOnDomain(static_cast<Matrix>(m), witness);
+            }
+        });
+        for (int row = 0; row < num_constraints; row++) {
+            if (values[0][row] * values[1][row] != values[2][row]) {
+                if (unsatisfied) *unsatisfied = static_cast<size_t>(row);
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Debugging aid: check a quotient against the witness at a point,
+    //   A(r)*B(r) - C(r) == Z(r)*H(r)
+    // A(r), B(r), C(r) come from the same sparse columns computePolynomials
+    // reads, so this catches faults in interpolation, multiplication or
+    // division, not in the R1CS -> QAP conversion. The prover does not run
+    // it: its exact division by Z already proves the identity.
+    bool checkQuotient(const std::vector<FieldElement>& witness, const Polynomial& H,
+                       const FieldElement& r) const {
+        FieldElement z = domain.evaluateVanishing(r);
+        if (z == FieldElement(0)) {
+            throw std::runtime_error("QAP check point lies on the evaluation domain");
+        }
+        FieldElement at_r[3];
+        evaluateWitnessAt(witness, r, at_r);
+        return at_r[0] * at_r[1] - at_r[2] == z * H.evaluate(r);
+    }
+
+    bool checkQuotient(const std::vector<FieldElement>& witness, const Polynomial& H) const {
+        return checkQuotient(witness, H, randomPoint());
+    }
     
-    // Convert R1CS to QAP using Lagrange interpolation
-    static QAP fromR1CS(const R1CS& r1cs) {
-        std::cout << "\n=== Converting R1CS to QAP ===" << std::endl;
-        
-        QAP qap;
-        qap.num_variables = r1cs.num_variables;
+    // Compute A(x), B(x), C(x) for a given witness. Each is evaluated on the
+    // domain straight from the sparse columns and interpolated once, so the
+    // per-variable coefficient polynomials are never needed.
+    void computePolynomials(const std::vector<FieldElement>& witness,
+                           Polynomial& A_x, Polynomial& B_x, Polynomial& C_x) const {
+        if (witness.size() < static_cast<size_t>(num_variables)) {
+            throw std::runtime_error("Witness is shorter than the number of QAP variables");
+        }
         
-        // Create evaluation points (1, 2, 3, ..., m) where m is number of constraints
-        std::vector<FieldElement> x_values;
-        for (int i = 0; i < r1cs.num_constraints; i++) {
-            x_values.push_back(FieldElement(i + 1));
+        Polynomial* outputs[3] = {&A_x, &B_x, &C_x};
+        parallelFor(0, 3, 1, [&](size_t lo, size_t hi) {
+            for (size_t m = lo; m < hi; m++) {
+                *outputs[m] = domain.interpolate(evaluateOnDomain(static_cast<Matrix>(m), witness));
+            }
+        });
+    }
+    
+    // A(x), B(x), C(x) for many witnesses of this circuit at once.
+    //
+    // With the K witnesses as rows of W (K x n), the K polynomials of one
+    // matrix are W times that matrix's n x N table of per-variable
+    // polynomials. Two forms of that product are used:
+    //  - Lagrange form (default): the table is the sparse columns. Each
+    //    domain row walks its non-zeros once and updates all K witnesses
+    //    with each of them, K being the contiguous, vectorised dimension;
+    //    K interpolations follow.
+    //  - Coefficient form: when it is already cached and the dense product
+    //    is cheaper than the sparse walk plus an NTT (circuits with few
+    //    variables), the polynomials come straight out of a blocked GEMM.
+    void computePolynomialsBatch(const std::vector<std::vector<FieldElement>>& witnesses,
+                                 std::vector<Polynomial>& A_out,
+                                 std::vector<Polynomial>& B_out,
+                                 std::vector<Polynomial>& C_out) const {
+        size_t batch = witnesses.size();
+        size_t n = static_cast<size_t>(num_variables);
+        size_t rows = static_cast<size_t>(num_constraints);
+        for (const auto& witness : witnesses) {
+            if (witness.size() < n) {
+                throw std::runtime_error("Witness is shorter than the number of QAP variables");
+            }
         }
         
-        std::cout << "Evaluation points: ";
-        for (const auto& x : x_values) {
-            std::cout << x << " ";
+        std::vector<Polynomial>* outputs[3] = {&A_out, &B_out, &C_out};
+        for (auto* out : outputs) {
+            out->assign(batch, Polynomial());
         }
-        std::cout << std::endl;
+        if (batch == 0) return;
+        
+        FieldMatrix W = FieldMatrix::fromRows(witnesses, n);
+        FieldMatrix W_t = W.transpose(); // n x K: one witness value per lane
         
-        // For each variable, create polynomials that interpolate constraint values
-        for (int var = 0; var < r1cs.num_variables; var++) {
-            std::vector<FieldElement> a_values, b_values, c_values;
+        // values[m][k] holds witness k's evaluations of matrix m
+        std::vector<std::vector<FieldElement>> values[3];
+        
+        for (int mi = 0; mi < 3; mi++) {
+            Matrix m = static_cast<Matrix>(mi);
+            const std::vector<SparseColumn>& cols = columns(m);
+            size_t nnz = 0;
+            for (const SparseColumn& column : cols) nnz += column.size();
             
-            for (int constraint = 0; constraint < r1cs.num_constraints; constraint++) {
-                a_values.push_back(r1cs.A[constraint][var]);
-                b_values.push_back(r1cs.B[constraint][var]);
-                c_values.push_back(r1cs.C[constraint][var]);
+            if (hasCoefficientPolynomials(m) &&
+                n * domain.size() <= nnz + EvaluationDomain::transformCost(domain.size())) {
+                const std::vector<Polynomial>& polys = coefficientPolynomials(m);
+                size_t width = 0;
+                for (const Polynomial& poly : polys) width = std::max(width, poly.coefficients.size());
+                std::vector<std::vector<FieldElement>> table(n);
+                for (size_t var = 0; var < n; var++) table[var] = polys[var].coefficients;
+                
+                FieldMatrix product;
+                gemm(W, FieldMatrix::fromRows(table, width), product);
+                for (size_t k = 0; k < batch; k++) {
+                    (*outputs[mi])[k] = Polynomial(std::vector<FieldElement>(product.row(k), product.row(k) + width));
+                }
+                continue;
             }
             
-            Polynomial a_poly = LagrangeInterpolation::interpolate(x_values, a_values);
-            Polynomial b_poly = LagrangeInterpolation::interpolate(x_values, b_values);
-            Polynomial c_poly = LagrangeInterpolation::interpolate(x_values, c_values);
-            
-            qap.A_polys.push_back(a_poly);
-            qap.B_polys.push_back(b_poly);
-            qap.C_polys.push_back(c_poly);
+            // Row-major view of the sparse columns (counting sort by row)
+            std::vector<size_t> row_start(rows + 1, 0);
+            for (const SparseColumn& column : cols) {
+                for (const SparseEntry& entry : column) row_start[entry.row + 1]++;
+            }
+            for (size_t r = 0; r < rows; r++) row_start[r + 1] += row_start[r];
+            std::vector<std::pair<uint32_t, uint32_t>> by_row(nnz); // (variable, value)
+            std::vector<size_t> fill(row_start.begin(), row_start.end() - 1);
+            for (size_t var = 0; var < n; var++) {
+                for (const SparseEntry& entry : cols[var]) {
+                    by_row[fill[entry.row]++] = {static_cast<uint32_t>(var),
+                                                 static_cast<uint32_t>(entry.value.getValue())};
+                }
+            }
             
-            std::cout << "Variable " << var << " polynomials created" << std::endl;
-        }
-        
-        // Create target polynomial Z(x) = (x - 1)(x - 2)...(x - m)
-        qap.Z = Polynomial({FieldElement(1)});
-        for (const auto& x : x_values) {
-            Polynomial factor({FieldElement(0) - x, FieldElement(1)});
-            qap.Z = qap.Z * factor;
+            values[mi].assign(batch, std::vector<FieldElement>(rows));
+            parallelFor(0, rows, 16, [&](size_t lo, size_t hi) {
+                ArenaScope scope(scratchArena());
+                std::pmr::vector<uint64_t> acc(batch, &scratchArena());
+                for (size_t r = lo; r < hi; r++) {
+                    std::fill(acc.begin(), acc.end(), 0);
+                    for (size_t e = row_start[r]; e < row_start[r + 1]; e++) {
+                        uint64_t value = by_row[e].second;
+                        const FieldElement* lanes = W_t.row(by_row[e].first);
+                        for (size_t k = 0; k < batch; k++) {
+                            acc[k] += FieldElement::foldProduct(value * lanes[k].getValue());
+                        }
+                    }
+                    for (size_t k = 0; k < batch; k++) {
+                        values[mi][k][r] = FieldElement(acc[k]);
+                    }
+                }
+            });
         }
         
-        std::cout << "Target polynomial Z(x) = ";
-        qap.Z.print();
-        std::cout << std::endl;
-        
-        return qap;
-    }
-    
-    // Compute A(x), B(x), C(x) for a given witness
-    void computePolynomials(const std::vector<FieldElement>& witness,
-                           Polynomial& A_x, Polynomial& B_x, Polynomial& C_x) const {
-        A_x = Polynomial({FieldElement(0)});
-        B_x = Polynomial({FieldElement(0)});
-        C_x = Polynomial({FieldElement(0)});
-        
-        for (int i = 0; i < num_variables; i++) {
-            A_x = A_x + A_polys[i] * witness[i];
-            B_x = B_x + B_polys[i] * witness[i];
-            C_x = C_x + C_polys[i] * witness[i];
-        }
+        // Interpolate every (matrix, witness) pair that went through Lagrange form
+        parallelFor(0, 3 * batch, 1, [&](size_t lo, size_t hi) {
+            for (size_t item = lo; item < hi; item++) {
+                size_t mi = item / batch;
+                size_t k = item % batch;
+                if (values[mi].empty()) continue;
+                (*outputs[mi])[k] = domain.interpolate(values[mi][k]);
+            }
+        });
     }
 };
 
@@ -0,0 +1,393 @@
+#ifndef QAP_CACHE_H
+#define QAP_CACHE_H
+
+#include "field.h"
+#include "r1cs.h"
+#include "domain.h"
+#include "qap.h"
+#include "mapped_file.h"
+#include <string>
+#include <vector>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <cstdio>
+#include <random>
+#include <cstring>
+#include <cstdint>
+#include <stdexcept>
+
+// Header of a serialised QAP. All fields are little-endian fixed-width
+// integers; the payload that follows is covered by `checksum`.
+//
+// Payload layout (every array starts on an 8-byte boundary):
+//   domain points                u32[point_count]          arbitrary domains only
+//   for A, B, C:
+//     column offsets             u64[num_variables + 1]    into the entry array
+//     entries (row, value)       u32[2 * nnz]
+//   if has_coefficients, for A, B, C:
+//     polynomial offsets         u64[num_variables + 1]    into the coefficient array
+//     coefficients               u32[total]
+struct QAPArtifactHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t key;               // QAPCache::key(r1cs, domain)
+    uint64_t num_variables;
+    uint64_t num_constraints;
+    uint64_t nnz[3];            // non-zero entries of A, B, C
+    uint32_t domain_kind;       // EvaluationDomain::Kind
+    uint32_t has_coefficients;
+    uint64_t domain_size;
+    uint64_t domain_offset;     // coset offset (1 for a subgroup)
+    uint64_t point_count;       // explicit points (arbitrary domains)
+    uint64_t payload_bytes;
+    uint64_t checksum;          // checksum64 of the payload
+};
+
+// On-disk cache of R1CS -> QAP conversions.
+//
+// The QAP is a pure function of the constraint system and the evaluation
+// domain, so a circuit that does not change is converted once and every
+// later process maps the stored artifact instead. Artifacts are named by a
+// hash of both inputs; a modified circuit simply misses the cache. The
+// hash is only 64 bits, so loading also compares the dimensions, the
+// non-zero counts and the domain against the requested conversion. A file
+// that fails validation is ignored and rebuilt.
+class QAPCache {
+private:
+    static constexpr uint32_t MAGIC = 0x31504151; // "QAP1"
+    static constexpr uint32_t VERSION = 2;
+
+    std::string directory;
+    bool store_coefficients;
+
+    static size_t align8(size_t bytes) { return (bytes + 7) & ~size_t(7); }
+
+    // Bytes taken by one matrix's sparse columns or coefficient polynomials
+    static size_t tableBytes(size_t num_variables, size_t words) {
+        return (num_variables + 1) * sizeof(uint64_t) + align8(words * sizeof(uint32_t));
+    }
+
+    // Sequential writer / reader over the mapped payload
+    struct Cursor {
+        char* base;
+        size_t offset;
+        size_t limit;
+
+        char* take(size_t bytes) {
+            bytes = align8(bytes);
+            if (offset + bytes > limit) {
+                throw std::runtime_error("QAP artifact is truncated");
+            }
+            char* p = base + offset;
+            offset += bytes;
+            return p;
+        }
+    };
+
+    static void writeColumns(Cursor& cursor, const std::vector<SparseColumn>& columns) {
+        uint64_t* offsets = reinterpret_cast<uint64_t*>(cursor.take((columns.size() + 1) * sizeof(uint64_t)));
+        uint64_t total = 0;
+        for (size_t var = 0; var < columns.size(); var++) {
+            offsets[var] = total;
+            total += columns[var].size();
+        }
+        offsets[columns.size()] = total;
+
+        uint32_t* words = reinterpret_cast<uint32_t*>(cursor.take(2 * total * sizeof(uint32_t)));
+        for (const SparseColumn& column : columns) {
+            for (const SparseEntry& entry : column) {
+                *words++ = entry.row;
+                *words++ = static_cast<uint32_t>(entry.value.getValue());
+            }
+        }
+    }
+
+    static std::vector<SparseColumn> readColumns(Cursor& cursor, size_t num_variables, size_t num_constraints) {
+        const uint64_t* offsets = reinterpret_cast<const uint64_t*>(cursor.take((num_variables + 1) * sizeof(uint64_t)));
+        uint64_t total = offsets[num_variables];
+        const uint32_t* words = reinterpret_cast<const uint32_t*>(cursor.take(2 * total * sizeof(uint32_t)));
+
+        std::vector<SparseColumn> columns(num_variables);
+        for (size_t var = 0; var < num_variables; var++) {
+            if (offsets[var] > offsets[var + 1] || offsets[var + 1] > total) {
+                throw std::runtime_error("QAP artifact has inconsistent column offsets");
+            }
+            columns[var].reserve(offsets[var + 1] - offsets[var]);
+            for (uint64_t e = offsets[var]; e < offsets[var + 1]; e++) {
+                uint32_t row = words[2 * e];
+                if (row >= num_constraints) {
+                    throw std::runtime_error("QAP artifact has an out-of-range row");
+                }
+                columns[var].push_back({row, FieldElement(words[2 * e + 1])});
+            }
+        }
+        return columns;
+    }
+
+    static void writePolynomials(Cursor& cursor, const std::vector<Polynomial>& polys) {
+        uint64_t* offsets = reinterpret_cast<uint64_t*>(cursor.take((polys.size() + 1) * sizeof(uint64_t)));
+        uint64_t total = 0;
+        for (size_t var = 0; var < polys.size(); var++) {
+            offsets[var] = total;
+            total += polys[var].coefficients.size();
+        }
+        offsets[polys.size()] = total;
+
+        uint32_t* words = reinterpret_cast<uint32_t*>(cursor.take(total * sizeof(uint32_t)));
+        for (const Polynomial& poly : polys) {
+            for (const FieldElement& c : poly.coefficients) {
+                *words++ = static_cast<uint32_t>(c.getValue());
+            }
+        }
+    }
+
+    static std::vector<Polynomial> readPolynomials(Cursor& cursor, size_t num_variables) {
+        const uint64_t* offsets = reinterpret_cast<const uint64_t*>(cursor.take((num_variables + 1) * sizeof(uint64_t)));
+        uint64_t total = offsets[num_variables];
+        const uint32_t* words = reinterpret_cast<const uint32_t*>(cursor.take(total * sizeof(uint32_t)));
+
+        std::vector<Polynomial> polys(num_variables);
+        for (size_t var = 0; var < num_variables; var++) {
+            if (offsets[var] > offsets[var + 1] || offsets[var + 1] > total) {
+                throw std::runtime_error("QAP artifact has inconsistent polynomial offsets");
+            }
+            std::vector<FieldElement>& coeffs = polys[var].coefficients;
+            coeffs.reserve(offsets[var + 1] - offsets[var]);
+            for (uint64_t i = offsets[var]; i < offsets[var + 1]; i++) {
+                coeffs.push_back(FieldElement(words[i]));
+            }
+        }
+        return polys;
+    }
+
+    static size_t columnWords(const std::vector<SparseColumn>& columns) {
+        size_t total = 0;
+        for (const SparseColumn& column : columns) total += 2 * column.size();
+        return total;
+    }
+
+    static uint64_t nonZeros(const std::vector<std::vector<FieldElement>>& matrix) {
+        uint64_t count = 0;
+        for (const std::vector<FieldElement>& row : matrix) {
+            for (const FieldElement& value : row) {
+                if (value.getValue() != 0) count++;
+            }
+        }
+        return count;
+    }
+
+    static size_t coefficientWords(const std::vector<Polynomial>& polys) {
+        size_t total = 0;
+        for (const Polynomial& poly : polys) total += poly.coefficients.size();
+        return total;
+    }
+
+public:
+    explicit QAPCache(const std::string& dir, bool with_coefficients = false)
+        : directory(dir), store_coefficients(with_coefficients) {}
+
+    // Cache key: the R1CS fingerprint combined with the domain description
+    static uint64_t key(const R1CS& r1cs, const EvaluationDomain& domain) {
+        uint64_t words[4] = {
+            r1cs.hash(),
+            static_cast<uint64_t>(domain.getKind()),
+            domain.size(),
+            domain.offset().getValue()
+        };
+        uint64_t h = checksum64(words, sizeof(words));
+        if (domain.getKind() == EvaluationDomain::Kind::Arbitrary) {
+            std::vector<uint64_t> points(domain.size());
+            for (size_t i = 0; i < domain.size(); i++) {
+                points[i] = domain.element(i).getValue();
+            }
+            h ^= checksum64(points.data(), points.size() * sizeof(uint64_t));
+        }
+        return h;
+    }
+
+    std::string pathFor(uint64_t k) const {
+        std::ostringstream name;
+        name << directory << "/qap-" << std::hex << std::setw(16) << std::setfill('0') << k << ".bin";
+        return name.str();
+    }
+
+    // Write a QAP artifact. The file is filled under a unique temporary name
+    // and renamed into place, so readers never see a partial artifact.
+    static void save(const QAP& qap, uint64_t k, const std::string& path, bool with_coefficients = false) {
+        size_t num_variables = static_cast<size_t>(qap.num_variables);
+        bool arbitrary = qap.domain.getKind() == EvaluationDomain::Kind::Arbitrary;
+        size_t point_count = arbitrary ? qap.domain.size() : 0;
+
+        size_t payload = align8(point_count * sizeof(uint32_t));
+        for (int m = 0; m < 3; m++) {
+            payload += tableBytes(num_variables, columnWords(qap.columns(static_cast<QAP::Matrix>(m))));
+        }
+        if (with_coefficients) {
+            qap.precomputeCoefficients();
+            for (int m = 0; m < 3; m++) {
+                payload += tableBytes(num_variables, coefficientWords(qap.coefficientPolynomials(static_cast<QAP::Matrix>(m))));
+            }
+        }
+
+        std::string staging = path + ".tmp" + std::to_string(std::random_device()());
+        {
+            MappedFile file = MappedFile::create(staging, sizeof(QAPArtifactHeader) + payload);
+            char* base = static_cast<char*>(file.data());
+            Cursor cursor{base + sizeof(QAPArtifactHeader), 0, payload};
+
+            uint32_t* points = reinterpret_cast<uint32_t*>(cursor.take(point_count * sizeof(uint32_t)));
+            for (size_t i = 0; i < point_count; i++) {
+                points[i] = static_cast<uint32_t>(qap.domain.element(i).getValue());
+            }
+            for (int m = 0; m < 3; m++) {
+                writeColumns(cursor, qap.columns(static_cast<QAP::Matrix>(m)));
+            }
+            if (with_coefficients) {
+                for (int m = 0; m < 3; m++) {
+                    writePolynomials(cursor, qap.coefficientPolynomials(static_cast<QAP::Matrix>(m)));
+                }
+            }
+
+            QAPArtifactHeader header{};
+            header.magic = MAGIC;
+            header.version = VERSION;
+            header.key = k;
+            header.num_variables = num_variables;
+            header.num_constraints = static_cast<uint64_t>(qap.num_constraints);
+            for (int m = 0; m < 3; m++) {
+                header.nnz[m] = columnWords(qap.columns(static_cast<QAP::Matrix>(m))) / 2;
+            }
+            header.domain_kind = static_cast<uint32_t>(qap.domain.getKind());
+            header.has_coefficients = with_coefficients ? 1 : 0;
+            header.domain_size = qap.domain.size();
+            header.domain_offset = qap.domain.offset().getValue();
+            header.point_count = point_count;
+            header.payload_bytes = payload;
+            header.checksum = checksum64(base + sizeof(QAPArtifactHeader), payload);
+            std::memcpy(base, &header, sizeof(header));
+            file.flush();
+        }
+
+        // rename replaces an old artifact atomically; Windows needs it gone first
+#ifdef _WIN32
+        std::remove(path.c_str());
+#endif
+        if (std::rename(staging.c_str(), path.c_str()) != 0) {
+            std::remove(staging.c_str());
+            throw std::runtime_error("Cannot publish QAP artifact " + path);
+        }
+    }
+
+    // Map an artifact and rebuild the QAP from it. Throws if the file is
+    // missing, was written for a different circuit or domain, or fails its
+    // checksum.
+    static QAP load(const std::string& path, const R1CS& r1cs, const EvaluationDomain& domain) {
+        MappedFile file = MappedFile::open(path);
+        if (file.size() < sizeof(QAPArtifactHeader)) {
+            throw std::runtime_error("QAP artifact is truncated");
+        }
+        QAPArtifactHeader header;
+        std::memcpy(&header, file.data(), sizeof(header));
+        if (header.magic != MAGIC || header.version != VERSION) {
+            throw std::runtime_error("Not a QAP artifact (or an unsupported version)");
+        }
+        // The key is a 64-bit hash: a colliding circuit is caught by its shape
+        if (header.key != key(r1cs, domain) ||
+            header.num_variables != static_cast<uint64_t>(r1cs.num_variables) ||
+            header.num_constraints != static_cast<uint64_t>(r1cs.num_constraints) ||
+            header.nnz[0] != nonZeros(r1cs.A) || header.nnz[1] != nonZeros(r1cs.B) ||
+            header.nnz[2] != nonZeros(r1cs.C)) {
+            throw std::runtime_error("QAP artifact was built for a different circuit");
+        }
+        if (header.domain_kind != static_cast<uint32_t>(domain.getKind()) ||
+            header.domain_size != domain.size() ||
+            header.domain_offset != domain.offset().getValue() ||
+            header.point_count != (domain.getKind() == EvaluationDomain::Kind::Arbitrary ? domain.size() : 0)) {
+            throw std::runtime_error("QAP artifact was built for a different domain");
+        }
+        if (header.payload_bytes != file.size() - sizeof(QAPArtifactHeader)) {
+            throw std::runtime_error("QAP artifact is truncated");
+        }
+
+        char* payload = static_cast<char*>(file.data()) + sizeof(QAPArtifactHeader);
+        file.prefetch(sizeof(QAPArtifactHeader), header.payload_bytes);
+        if (checksum64(payload, header.payload_bytes) != header.checksum) {
+            throw std::runtime_error("QAP artifact failed its checksum");
+        }
+
+        size_t num_variables = header.num_variables;
+        size_t num_constraints = header.num_constraints;
+        Cursor cursor{payload, 0, header.payload_bytes};
+
+        QAP qap;
+        qap.num_variables = static_cast<int>(num_variables);
+        qap.num_constraints = static_cast<int>(num_constraints);
+
+        const uint32_t* points = reinterpret_cast<const uint32_t*>(cursor.take(header.point_count * sizeof(uint32_t)));
+        if (header.domain_kind == static_cast<uint32_t>(EvaluationDomain::Kind::Arbitrary)) {
+            std::vector<FieldElement> x_values(points, points + header.point_count);
+            qap.domain = EvaluationDomain::arbitrary(x_values);
+        } else {
+            qap.domain = EvaluationDomain::withSize(header.domain_size, FieldElement(header.domain_offset));
+        }
+        if (qap.domain.size() < num_constraints) {
+            throw std::runtime_error("QAP artifact domain is smaller than its constraint count");
+        }
+        for (size_t i = 0; i < header.point_count; i++) {
+            if (qap.domain.element(i) != domain.element(i)) {
+                throw std::runtime_error("QAP artifact was built for a different domain");
+            }
+        }
+
+        qap.A_columns = readColumns(cursor, num_variables, num_constraints);
+        qap.B_columns = readColumns(cursor, num_variables, num_constraints);
+        qap.C_columns = readColumns(cursor, num_variables, num_constraints);
+        for (int m = 0; m < 3; m++) {
+            if (columnWords(qap.columns(static_cast<QAP::Matrix>(m))) / 2 != header.nnz[m]) {
+                throw std::runtime_error("QAP artifact entry count does not match its header");
+            }
+        }
+
+        if (header.has_coefficients) {
+            for (int m = 0; m < 3; m++) {
+                qap.setCoefficientPolynomials(static_cast<QAP::Matrix>(m), readPolynomials(cursor, num_variables));
+            }
+        }
+        return qap;
+    }
+
+    // QAP::fromR1CS over the default subgroup, through the cache
+    QAP fromR1CS(const R1CS& r1cs) const {
+        return fromR1CS(r1cs, EvaluationDomain::subgroup(r1cs.num_constraints));
+    }
+
+    // QAP::fromR1CS through the cache: load the artifact if a valid one
+    // exists, otherwise convert and store the result for the next run
+    QAP fromR1CS(const R1CS& r1cs, const EvaluationDomain& domain) const {
+        uint64_t k = key(r1cs, domain);
+        std::string path = pathFor(k);
+
+        if (std::ifstream(path).good()) {
+            try {
+                QAP qap = load(path, r1cs, domain);
+                std::cout << "Loaded QAP from cache: " << path << std::endl;
+                return qap;
+            } catch (const std::runtime_error& e) {
+                std::cout << "Ignoring QAP cache entry " << path << ": " << e.what() << std::endl;
+            }
+        }
+
+        QAP qap = QAP::fromR1CS(r1cs, domain);
+        try {
+            save(qap, k, path, store_coefficients);
+            std::cout << "Stored QAP in cache: " << path << std::endl;
+        } catch (const std::runtime_error& e) {
+            std::cout << "Warning: could not store QAP in cache: " << e.what() << std::endl;
+        }
+        return qap;
+    }
+};
+
+#endif // QAP_CACHE_H
@@ -77,6 +77,31 @@ public:
         return true;
     }
     
+    // 64-bit FNV-1a fingerprint of the dimensions and every non-zero entry;
+    // identifies the constraint system for on-disk caches
+    uint64_t hash() const {
+        uint64_t h = 0xcbf29ce484222325ULL;
+        auto mix = [&h](uint64_t word) {
+            h ^= word;
+            h *= 0x100000001b3ULL;
+        };
+        mix(static_cast<uint64_t>(num_variables));
+        mix(static_cast<uint64_t>(num_constraints));
+        const std::vector<std::vector<FieldElement>>* matrices[3] = {&A, &B, &C};
+        for (int m = 0; m < 3; m++) {
+            mix(0xA0 + m);
+            for (int i = 0; i < num_constraints; i++) {
+                for (int j = 0; j < num_variables; j++) {
+                    uint64_t value = (*matrices[m])[i][j].getValue();
+                    if (value == 0) continue;
+                    mix((static_cast<uint64_t>(i) << 32) | static_cast<uint64_t>(j));
+                    mix(value);
+                }
+            }
+        }
+        return h;
+    }
+
     void print() const {
         std::cout << "\n=== R1CS System ===" << std::endl;
         std::cout << "Variables: " << num_variables << std::endl;
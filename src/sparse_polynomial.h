@@ -0,0 +1,229 @@
+#ifndef SPARSE_POLYNOMIAL_H
+#define SPARSE_POLYNOMIAL_H
+
+#include "field.h"
+#include "polynomial.h"
+#include "parallel.h"
+#include "arena.h"
+#include <vector>
+#include <iostream>
+#include <algorithm>
+#include <stdexcept>
+#include <cstdint>
+
+// One non-zero term coefficient * x^exponent
+struct SparseTerm {
+    uint64_t exponent;
+    FieldElement coefficient;
+};
+
+// Polynomial stored as its non-zero terms, sorted by exponent.
+//
+// Meant for structured polynomials that are mostly zero: vanishing
+// polynomials x^N - c, selectors, single sparse constraint columns. Work
+// scales with the number of terms instead of the degree: evaluation costs
+// O(t log N), and a product or quotient with a dense polynomial of length
+// L costs O(L t) instead of O(L N).
+class SparsePolynomial {
+public:
+    std::vector<SparseTerm> terms; // increasing exponents, no zero coefficients
+
+private:
+    void normalize() {
+        std::sort(terms.begin(), terms.end(), [](const SparseTerm& a, const SparseTerm& b) {
+            return a.exponent < b.exponent;
+        });
+        size_t out = 0;
+        for (size_t i = 0; i < terms.size();) {
+            SparseTerm merged = terms[i];
+            size_t j = i + 1;
+            while (j < terms.size() && terms[j].exponent == merged.exponent) {
+                merged.coefficient = merged.coefficient + terms[j].coefficient;
+                j++;
+            }
+            if (merged.coefficient != FieldElement(0)) {
+                terms[out++] = merged;
+            }
+            i = j;
+        }
+        terms.resize(out);
+    }
+
+public:
+    SparsePolynomial() {}
+
+    // Terms in any order; equal exponents are merged, zeros dropped
+    SparsePolynomial(std::vector<SparseTerm> unsorted) : terms(std::move(unsorted)) {
+        normalize();
+    }
+
+    static SparsePolynomial monomial(const FieldElement& coefficient, uint64_t exponent) {
+        return SparsePolynomial({{exponent, coefficient}});
+    }
+
+    // x^n - c (the vanishing polynomial of a coset with g^N = c)
+    static SparsePolynomial vanishing(uint64_t n, const FieldElement& c) {
+        return SparsePolynomial({{0, FieldElement(0) - c}, {n, FieldElement(1)}});
+    }
+
+    static SparsePolynomial fromDense(const Polynomial& p) {
+        SparsePolynomial result;
+        for (size_t i = 0; i < p.coefficients.size(); i++) {
+            if (p.coefficients[i] != FieldElement(0)) {
+                result.terms.push_back({i, p.coefficients[i]});
+            }
+        }
+        return result;
+    }
+
+    Polynomial toDense() const {
+        if (terms.empty()) return Polynomial({FieldElement(0)});
+        std::vector<FieldElement> coeffs(terms.back().exponent + 1, FieldElement(0));
+        for (const SparseTerm& term : terms) {
+            coeffs[term.exponent] = term.coefficient;
+        }
+        return Polynomial(std::move(coeffs));
+    }
+
+    bool isZero() const { return terms.empty(); }
+    size_t termCount() const { return terms.size(); }
+
+    // Degree (-1 for the zero polynomial)
+    int64_t degree() const {
+        return terms.empty() ? -1 : static_cast<int64_t>(terms.back().exponent);
+    }
+
+    // Evaluate by exponentiating the gaps between consecutive exponents
+    FieldElement evaluate(const FieldElement& x) const {
+        FieldElement result(0);
+        FieldElement x_power(1);
+        uint64_t last = 0;
+        for (const SparseTerm& term : terms) {
+            x_power = x_power * x.power(term.exponent - last);
+            last = term.exponent;
+            result = result + term.coefficient * x_power;
+        }
+        return result;
+    }
+
+    SparsePolynomial operator+(const SparsePolynomial& other) const {
+        std::vector<SparseTerm> merged = terms;
+        merged.insert(merged.end(), other.terms.begin(), other.terms.end());
+        return SparsePolynomial(std::move(merged));
+    }
+
+    SparsePolynomial operator-(const SparsePolynomial& other) const {
+        return *this + other * FieldElement(FieldElement::getPrime() - 1);
+    }
+
+    SparsePolynomial operator*(const FieldElement& scalar) const {
+        std::vector<SparseTerm> scaled = terms;
+        for (SparseTerm& term : scaled) {
+            term.coefficient = term.coefficient * scalar;
+        }
+        return SparsePolynomial(std::move(scaled));
+    }
+
+    // Sparse x sparse: t1 * t2 products, merged
+    SparsePolynomial operator*(const SparsePolynomial& other) const {
+        std::vector<SparseTerm> products;
+        products.reserve(terms.size() * other.terms.size());
+        for (const SparseTerm& a : terms) {
+            for (const SparseTerm& b : other.terms) {
+                products.push_back({a.exponent + b.exponent, a.coefficient * b.coefficient});
+            }
+        }
+        return SparsePolynomial(std::move(products));
+    }
+
+    // Dense x sparse: every term adds a scaled, shifted copy of the dense
+    // operand. Products are folded below 2^32 and summed in 64 bits, so each
+    // output coefficient is reduced once; output blocks run in parallel.
+    static Polynomial multiply(const Polynomial& dense, const SparsePolynomial& sparse) {
+        if (dense.coefficients.empty() || sparse.terms.empty()) {
+            return Polynomial({FieldElement(0)});
+        }
+        const std::vector<FieldElement>& a = dense.coefficients;
+        size_t result_size = a.size() + sparse.terms.back().exponent;
+        std::vector<FieldElement> result(result_size);
+
+        parallelFor(0, result_size, 4096, [&](size_t lo, size_t hi) {
+            ArenaScope scope(scratchArena());
+            std::pmr::vector<uint64_t> acc(hi - lo, 0, &scratchArena());
+            for (const SparseTerm& term : sparse.terms) {
+                // Outputs k in [lo, hi) with k - exponent in [0, a.size())
+                size_t e = term.exponent;
+                size_t begin = std::max(lo, e);
+                size_t end = std::min(hi, a.size() + e);
+                uint64_t c = term.coefficient.getValue();
+                for (size_t k = begin; k < end; k++) {
+                    acc[k - lo] += FieldElement::foldProduct(c * a[k - e].getValue());
+                }
+            }
+            for (size_t k = lo; k < hi; k++) {
+                result[k] = FieldElement(acc[k - lo]);
+            }
+        });
+        return Polynomial(std::move(result));
+    }
+
+    // Long division of a dense polynomial by a sparse divisor: each step
+    // touches only the divisor's t terms, so the cost is O(L t)
+    static Polynomial divide(const Polynomial& dividend, const SparsePolynomial& divisor,
+                             Polynomial& remainder) {
+        if (divisor.terms.empty()) {
+            throw std::runtime_error("Division by zero polynomial");
+        }
+
+        size_t d = divisor.terms.back().exponent;
+        std::vector<FieldElement> rem = dividend.coefficients;
+        int rem_degree = dividend.degree();
+        if (rem_degree < static_cast<int>(d)) {
+            remainder = Polynomial(rem);
+            return Polynomial({FieldElement(0)});
+        }
+
+        size_t top = static_cast<size_t>(rem_degree);
+        std::vector<FieldElement> quot(top - d + 1, FieldElement(0));
+        FieldElement lead_inv = divisor.terms.back().coefficient.inverse();
+        size_t lower_terms = divisor.terms.size() - 1;
+
+        for (size_t i = top + 1; i-- > d;) {
+            FieldElement factor = rem[i] * lead_inv;
+            quot[i - d] = factor;
+            if (factor == FieldElement(0)) continue;
+            rem[i] = FieldElement(0); // cancelled by the leading term
+            for (size_t t = 0; t < lower_terms; t++) {
+                const SparseTerm& term = divisor.terms[t];
+                rem[i - d + term.exponent] = rem[i - d + term.exponent] - factor * term.coefficient;
+            }
+        }
+
+        rem.resize(d > 0 ? d : 1);
+        remainder = Polynomial(rem);
+        return Polynomial(quot);
+    }
+
+    void print() const {
+        if (terms.empty()) {
+            std::cout << "0";
+            return;
+        }
+        for (size_t i = terms.size(); i-- > 0;) {
+            std::cout << terms[i].coefficient;
+            if (terms[i].exponent > 0) std::cout << "·x^" << terms[i].exponent;
+            if (i > 0) std::cout << " + ";
+        }
+    }
+};
+
+// Mixed products with the sparse operand on either side
+inline Polynomial operator*(const Polynomial& dense, const SparsePolynomial& sparse) {
+    return SparsePolynomial::multiply(dense, sparse);
+}
+
+inline Polynomial operator*(const SparsePolynomial& sparse, const Polynomial& dense) {
+    return SparsePolynomial::multiply(dense, sparse);
+}
+
+#endif // SPARSE_POLYNOMIAL_H
@@ -0,0 +1,175 @@
+#ifndef TWIDDLE_H
+#define TWIDDLE_H
+
+#include "field.h"
+#include <vector>
+#include <array>
+#include <map>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <cstdint>
+
+// Roots of unity for small domains, computed at compile time.
+// 1386 = 2 * 3^2 * 7 * 11 is the largest divisor of p - 1 built only from
+// the small primes, so every subgroup of size d | 1386 takes its roots from
+// this one table with stride 1386 / d.
+namespace small_roots {
+    constexpr uint64_t PRIME = 2147483647ULL;
+    constexpr size_t ORDER = 1386;
+
+    constexpr uint64_t mulMod(uint64_t a, uint64_t b) {
+        return static_cast<uint64_t>((static_cast<__uint128_t>(a) * b) % PRIME);
+    }
+
+    constexpr uint64_t powMod(uint64_t base, uint64_t exp) {
+        uint64_t result = 1;
+        while (exp > 0) {
+            if (exp & 1) result = mulMod(result, base);
+            base = mulMod(base, base);
+            exp >>= 1;
+        }
+        return result;
+    }
+
+    constexpr std::array<uint64_t, ORDER> build() {
+        std::array<uint64_t, ORDER> roots{};
+        uint64_t omega = powMod(7, (PRIME - 1) / ORDER);
+        uint64_t w = 1;
+        for (size_t i = 0; i < ORDER; i++) {
+            roots[i] = w;
+            w = mulMod(w, omega);
+        }
+        return roots;
+    }
+
+    constexpr std::array<uint64_t, ORDER> TABLE = build();
+}
+
+// Twiddle table for one domain size: the powers w^0, ..., w^(N-1) of the
+// primitive N-th root of unity, each with its Shoup companion so butterflies
+// multiply without a division. Tables are immutable once built. Every
+// domain of the same size shares one table through TwiddleTable::forSize,
+// so the roots are computed once while any domain of that size is alive.
+// The registry holds only weak references plus the RECENT_TABLES most
+// recently requested tables, so sizes used once (e.g. by
+// EvaluationDomain::multiply) are freed again.
+class TwiddleTable {
+private:
+    static constexpr size_t RECENT_TABLES = 8;
+
+    size_t n;
+    FieldElement omega;
+    std::vector<FieldElement> roots;
+    std::vector<uint64_t> shoup;
+
+    static std::map<size_t, std::weak_ptr<const TwiddleTable>>& registry() {
+        static std::map<size_t, std::weak_ptr<const TwiddleTable>> tables;
+        return tables;
+    }
+
+    // Strong references to the most recently requested tables, newest first
+    static std::deque<std::shared_ptr<const TwiddleTable>>& recent() {
+        static std::deque<std::shared_ptr<const TwiddleTable>> tables;
+        return tables;
+    }
+
+    // Record a table as just used; the caller holds the registry mutex
+    static void touch(const std::shared_ptr<const TwiddleTable>& table) {
+        auto& tables = recent();
+        for (auto it = tables.begin(); it != tables.end(); ++it) {
+            if (*it == table) {
+                tables.erase(it);
+                break;
+            }
+        }
+        tables.push_front(table);
+        if (tables.size() > RECENT_TABLES) tables.pop_back();
+    }
+
+    // Drop the entries of tables nobody holds any more
+    static void prune() {
+        auto& tables = registry();
+        for (auto it = tables.begin(); it != tables.end();) {
+            if (it->second.expired()) {
+                it = tables.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    static std::mutex& registryMutex() {
+        static std::mutex mutex;
+        return mutex;
+    }
+
+    void fillShoup() {
+        shoup.resize(n);
+        for (size_t i = 0; i < n; i++) {
+            shoup[i] = FieldElement::shoupPrecompute(roots[i]);
+        }
+    }
+
+public:
+    TwiddleTable() : n(0), omega(1) {}
+
+    // Build the table for a subgroup of size `size` (must divide p - 1)
+    static std::shared_ptr<const TwiddleTable> build(size_t size) {
+        auto table = std::make_shared<TwiddleTable>();
+        table->n = size;
+        table->omega = FieldElement::rootOfUnity(size);
+        table->roots.resize(size);
+
+        if (small_roots::ORDER % size == 0) {
+            size_t stride = small_roots::ORDER / size;
+            for (size_t i = 0; i < size; i++) {
+                table->roots[i] = FieldElement(small_roots::TABLE[i * stride]);
+            }
+        } else {
+            FieldElement w(1);
+            for (size_t i = 0; i < size; i++) {
+                table->roots[i] = w;
+                w = w * table->omega;
+            }
+        }
+        table->fillShoup();
+        return table;
+    }
+
+    // Shared, read-only table for this size; built when no live one exists
+    static std::shared_ptr<const TwiddleTable> forSize(size_t size) {
+        std::lock_guard<std::mutex> lock(registryMutex());
+        auto& tables = registry();
+        auto it = tables.find(size);
+        std::shared_ptr<const TwiddleTable> table;
+        if (it != tables.end()) table = it->second.lock();
+        if (!table) {
+            table = build(size);
+            prune();
+            tables[size] = table;
+        }
+        touch(table);
+        return table;
+    }
+
+    // Sizes with a live table in the registry
+    static size_t registeredTables() {
+        std::lock_guard<std::mutex> lock(registryMutex());
+        prune();
+        return registry().size();
+    }
+
+    size_t size() const { return n; }
+    FieldElement generator() const { return omega; }
+    const std::vector<FieldElement>& getRoots() const { return roots; }
+    const FieldElement* rootData() const { return roots.data(); }
+    const uint64_t* shoupData() const { return shoup.data(); }
+
+    // a * w^i using the precomputed companion
+    FieldElement mul(const FieldElement& a, size_t i) const {
+        return FieldElement::mulShoup(a, roots[i], shoup[i]);
+    }
+};
+
+#endif // TWIDDLE_H
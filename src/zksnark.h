@@ -2,105 +2,309 @@
 #define ZKSNARK_H
 
 #include "field.h"
-#include "elliptic_curve.h"
+#include "pairing.h"
 #include "r1cs.h"
 #include "qap.h"
+#include "msm.h"
+#include "parallel.h"
+#include "fixed_base.h"
+#include "proving_key_file.h"
 #include <vector>
+#include <string>
+#include <algorithm>
 #include <iostream>
 #include <random>
+#include <stdexcept>
+#include <atomic>
+#include <utility>
+#include <type_traits>
 
-// Proving Key
-struct ProvingKey {
-    std::vector<ECPoint> A_query;
-    std::vector<ECPoint> B_query;
-    std::vector<ECPoint> C_query;
-    ECPoint alpha;
-    ECPoint beta;
-    ECPoint delta;
-    std::vector<ECPoint> Z_query;
+// Groth16 over a pairing backend (see pairing.h), generic in the way
+// kzg.h is. Keys and proofs are elements of the backend's groups: [x]_1
+// and [x]_2 are x times the G1 and G2 generators, so every scalar lives
+// in the field the groups have as their order.
+//
+// The backend must be symmetric (G1 and G2 the same group with the same
+// generator, as for ToyPairing). [B_i(tau)]_2 is then [B_i(tau)]_1, and
+// one B query serves both the G1 and the G2 sum; an asymmetric backend
+// would need a [B_i(tau)]_2 query of its own.
+
+// Thrown by the prover for a witness that does not satisfy the QAP, so
+// callers can tell a bad job from a failure of the prover itself
+struct InvalidWitnessError : std::runtime_error {
+    using std::runtime_error::runtime_error;
+};
+
+// Proving Key. Scalars are evaluated at the secret tau.
+template <typename Pairing>
+struct Groth16ProvingKey {
+    using Backend = Pairing;
+    using G1 = typename Pairing::G1;
+    using G2 = typename Pairing::G2;
+
+    G1 alpha;                               // [alpha]_1
+    G1 beta;                                // [beta]_1
+    G2 beta_g2;                             // [beta]_2
+    G1 delta;                               // [delta]_1
+    G2 delta_g2;                            // [delta]_2
+    std::vector<G1> A_query;                // [A_i(tau)]_1 for every variable
+    std::vector<G1> B_query;                // [B_i(tau)]_1 for every variable
+    std::vector<G1> H_query;                // [tau^i Z(tau) / delta]_1, i < N - 1
+    std::vector<G1> L_query;                // [(beta A_i + alpha B_i + C_i)(tau) / delta]_1, private i
+    std::vector<size_t> private_variables;  // variable index of each L_query entry
 };
 
 // Verification Key
-struct VerificationKey {
-    ECPoint alpha;
-    ECPoint beta;
-    ECPoint gamma;
-    ECPoint delta;
-    std::vector<ECPoint> IC; // Input consistency check values
+template <typename Pairing>
+struct Groth16VerificationKey {
+    typename Pairing::G1 alpha;             // [alpha]_1
+    typename Pairing::G2 beta;              // [beta]_2
+    typename Pairing::G2 gamma;             // [gamma]_2
+    typename Pairing::G2 delta;             // [delta]_2
+    std::vector<typename Pairing::G1> IC;   // [(beta A_i + alpha B_i + C_i)(tau) / gamma]_1 for one and each public input
+};
+
+// Scalars behind every key element (stage 1 of setup), derived from the
+// toxic waste. Queries are generated from them in any chunking.
+struct SetupScalars {
+    FieldElement tau, alpha, beta, gamma, delta;
+    std::vector<FieldElement> a_at_tau;
+    std::vector<FieldElement> b_at_tau;
+    std::vector<FieldElement> c_at_tau;
+    std::vector<size_t> public_variables;   // excluding the constant one
+    std::vector<size_t> private_variables;
+    FieldElement z_over_delta;              // Z(tau) / delta
+    size_t h_size = 0;
+    
+    uint64_t count(KeySection section) const {
+        switch (section) {
+            case KeySection::A:
+            case KeySection::B: return a_at_tau.size();
+            case KeySection::H: return h_size;
+            case KeySection::L: return private_variables.size();
+        }
+        return 0;
+    }
+    
+    // beta A_i(tau) + alpha B_i(tau) + C_i(tau)
+    FieldElement combined(size_t var) const {
+        return beta * a_at_tau[var] + alpha * b_at_tau[var] + c_at_tau[var];
+    }
+    
+    // Scalars [begin, end) of one query
+    void fill(KeySection section, size_t begin, size_t end, FieldElement* out) const {
+        switch (section) {
+            case KeySection::A:
+                std::copy(a_at_tau.begin() + begin, a_at_tau.begin() + end, out);
+                break;
+            case KeySection::B:
+                std::copy(b_at_tau.begin() + begin, b_at_tau.begin() + end, out);
+                break;
+            case KeySection::H: {
+                FieldElement value = z_over_delta * tau.power(begin);
+                for (size_t i = begin; i < end; i++) {
+                    out[i - begin] = value;
+                    value = value * tau;
+                }
+                break;
+            }
+            case KeySection::L: {
+                FieldElement delta_inv = delta.inverse();
+                parallelFor(begin, end, 4096, [&](size_t lo, size_t hi) {
+                    for (size_t i = lo; i < hi; i++) {
+                        out[i - begin] = combined(private_variables[i]) * delta_inv;
+                    }
+                });
+                break;
+            }
+        }
+    }
+    
+    // IC scalars: the constant one, then each public input, over gamma
+    std::vector<FieldElement> icScalars() const {
+        FieldElement gamma_inv = gamma.inverse();
+        std::vector<FieldElement> result;
+        result.push_back(combined(0) * gamma_inv);
+        for (size_t var : public_variables) {
+            result.push_back(combined(var) * gamma_inv);
+        }
+        return result;
+    }
 };
 
 // Proof
-struct Proof {
-    ECPoint A;
-    ECPoint B;
-    ECPoint C;
+template <typename Pairing>
+struct Groth16Proof {
+    typename Pairing::G1 A;
+    typename Pairing::G2 B;
+    typename Pairing::G1 C;
+};
+
+// State of one proof between the stages of Groth16::prove
+template <typename Pairing>
+struct Groth16ProverJob {
+    std::vector<FieldElement> w;            // witness over the QAP's variables
+    std::vector<FieldElement> w_private;    // witness of each L_query entry
+    Polynomial A_poly, B_poly, C_poly, H_poly;
+    std::vector<FieldElement> h_coeffs;     // H padded to the H query
+    FieldElement r, s;                      // blinding factors
+    typename Pairing::G1 sums[KEY_SECTION_COUNT];   // query MSMs, by KeySection
+};
+
+// Verification key prepared once per circuit for repeated verification.
+// e(alpha, beta) does not depend on the proof, so it is paired once here
+// and each check is a three-pair multi-pairing against it. Each IC element
+// gets a fixed-base table, so the input commitment
+//   vk_x = IC[0] + sum_i input_i IC[i + 1]
+// costs one table lookup and addition per window of each input instead of
+// a double-and-add.
+//
+// verify() allocates nothing and does no I/O.
+template <typename Pairing>
+class Groth16PreparedVerificationKey {
+public:
+    using G1 = typename Pairing::G1;
+    using G2 = typename Pairing::G2;
+    using GT = typename Pairing::GT;
+
+    // Fixed elements of the verify equation
+    GT alpha_beta;      // e(alpha, beta)
+    G2 gamma;
+    G2 delta;
+
+private:
+    G1 ic_constant;
+    std::vector<FixedBaseTable<G1>> ic_tables;
+
+public:
+    explicit Groth16PreparedVerificationKey(const Groth16VerificationKey<Pairing>& vk, unsigned window_bits = 8)
+        : alpha_beta(Pairing::pair(vk.alpha, vk.beta)), gamma(vk.gamma), delta(vk.delta) {
+        if (vk.IC.empty()) {
+            throw std::runtime_error("Verification key has no IC elements");
+        }
+        ic_constant = vk.IC[0];
+        ic_tables.reserve(vk.IC.size() - 1);
+        for (size_t i = 1; i < vk.IC.size(); i++) {
+            ic_tables.emplace_back(vk.IC[i], window_bits);
+        }
+    }
+
+    size_t numPublicInputs() const { return ic_tables.size(); }
+
+    // vk_x for the given public inputs
+    G1 inputCommitment(const FieldElement* public_inputs) const {
+        G1 vk_x = ic_constant;
+        for (size_t i = 0; i < ic_tables.size(); i++) {
+            vk_x = vk_x + ic_tables[i].multiply(public_inputs[i].getValue());
+        }
+        return vk_x;
+    }
+
+    // Same acceptance as Groth16::verify; false when the number of public
+    // inputs does not match the key. vk_x is stored if requested.
+    bool verify(const Groth16Proof<Pairing>& proof, const FieldElement* public_inputs, size_t count,
+                G1* vk_x = nullptr) const {
+        if (count != ic_tables.size()) return false;
+        G1 commitment = inputCommitment(public_inputs);
+        if (vk_x != nullptr) *vk_x = commitment;
+        
+        // e(A, B) e(vk_x, gamma)^-1 e(C, delta)^-1 = e(alpha, beta)
+        const std::pair<G1, G2> pairs[] = {
+            {proof.A, proof.B}, {G1() - commitment, gamma}, {G1() - proof.C, delta}};
+        return Pairing::check(pairs, 3, alpha_beta);
+    }
+
+    bool verify(const Groth16Proof<Pairing>& proof, const std::vector<FieldElement>& public_inputs,
+                G1* vk_x = nullptr) const {
+        return verify(proof, public_inputs.data(), public_inputs.size(), vk_x);
+    }
 };
 
-class zkSNARK {
+template <typename Pairing>
+class Groth16 {
+public:
+    using G1 = typename Pairing::G1;
+    using G2 = typename Pairing::G2;
+    using ProvingKey = Groth16ProvingKey<Pairing>;
+    using MappedProvingKey = Groth16MappedProvingKey<Pairing>;
+    using VerificationKey = Groth16VerificationKey<Pairing>;
+    using Proof = Groth16Proof<Pairing>;
+    using ProverJob = Groth16ProverJob<Pairing>;
+
+    static_assert(std::is_same<G1, G2>::value, "Groth16 here needs a symmetric pairing backend");
+
 private:
+    // One generator per thread: proofs may run concurrently
     static uint64_t randomScalar() {
-        static std::random_device rd;
-        static std::mt19937_64 gen(rd());
+        thread_local std::mt19937_64 gen(std::random_device{}());
         std::uniform_int_distribution<uint64_t> dis(1, FieldElement::getPrime() - 1);
         return dis(gen);
     }
 
-public:
-    // Setup phase: Generate proving and verification keys
-    static void setup(const QAP& qap, const R1CS& r1cs, 
-                     ProvingKey& pk, VerificationKey& vk, 
-                     int num_public_inputs) {
-        std::cout << "\n=== zkSNARK Setup Phase ===" << std::endl;
+    // Stage 1 of setup: draw the toxic waste and evaluate the QAP at tau
+    static SetupScalars prepareSetup(const QAP& qap, const std::vector<size_t>& public_variables) {
+        if (!(Pairing::g1() == Pairing::g2())) {
+            throw std::runtime_error("Groth16 here needs the G1 and G2 generators to agree");
+        }
+        size_t n = static_cast<size_t>(qap.num_variables);
+        std::vector<bool> is_public(n, false);
+        is_public[0] = true;
+        for (size_t var : public_variables) {
+            if (var == 0 || var >= n) {
+                throw std::runtime_error("Public input index out of range");
+            }
+            is_public[var] = true;
+        }
         
         // Generate random toxic waste (should be destroyed after setup!)
-        uint64_t tau = randomScalar();
-        uint64_t alpha_scalar = randomScalar();
-        uint64_t beta_scalar = randomScalar();
-        uint64_t gamma_scalar = randomScalar();
-        uint64_t delta_scalar = randomScalar();
+        SetupScalars sc;
+        sc.tau = FieldElement(randomScalar());
+        sc.alpha = FieldElement(randomScalar());
+        sc.beta = FieldElement(randomScalar());
+        sc.gamma = FieldElement(randomScalar());
+        sc.delta = FieldElement(randomScalar());
         
         std::cout << "Generated random parameters (toxic waste):" << std::endl;
-        std::cout << "  tau = " << tau << std::endl;
-        std::cout << "  alpha = " << alpha_scalar << std::endl;
-        std::cout << "  beta = " << beta_scalar << std::endl;
-        std::cout << "  gamma = " << gamma_scalar << std::endl;
-        std::cout << "  delta = " << delta_scalar << std::endl;
-        
-        // Create generator point
-        ECPoint::setCurveParams(FieldElement(0), FieldElement(7));
-        ECPoint G(FieldElement(2), FieldElement(1234567)); // Simplified generator
-        
-        std::cout << "\nGenerator point G = " << G << std::endl;
-        
-        // Generate proving key queries
-        std::cout << "\nGenerating proving key queries..." << std::endl;
-        for (int i = 0; i < qap.num_variables; i++) {
-            FieldElement tau_fe(tau);
-            FieldElement a_val = qap.A_polys[i].evaluate(tau_fe);
-            FieldElement b_val = qap.B_polys[i].evaluate(tau_fe);
-            FieldElement c_val = qap.C_polys[i].evaluate(tau_fe);
-            
-            pk.A_query.push_back(G * a_val.getValue());
-            pk.B_query.push_back(G * b_val.getValue());
-            pk.C_query.push_back(G * c_val.getValue());
-            
-            std::cout << "  Variable " << i << " queries generated" << std::endl;
+        std::cout << "  tau = " << sc.tau << std::endl;
+        std::cout << "  alpha = " << sc.alpha << std::endl;
+        std::cout << "  beta = " << sc.beta << std::endl;
+        std::cout << "  gamma = " << sc.gamma << std::endl;
+        std::cout << "  delta = " << sc.delta << std::endl;
+        
+        // A_i(tau) = sum_j A[j][i] * L_j(tau): all Lagrange basis values at
+        // tau come from the domain in O(N) and the QAP's sparse columns do
+        // the rest in O(nnz), so no polynomial is evaluated
+        std::vector<FieldElement> lagrange = qap.domain.lagrangeCoefficients(sc.tau);
+        sc.a_at_tau = qap.evaluateAt(QAP::Matrix::A, lagrange);
+        sc.b_at_tau = qap.evaluateAt(QAP::Matrix::B, lagrange);
+        sc.c_at_tau = qap.evaluateAt(QAP::Matrix::C, lagrange);
+        
+        sc.public_variables = public_variables;
+        for (size_t i = 0; i < n; i++) {
+            if (!is_public[i]) sc.private_variables.push_back(i);
         }
         
-        // Generate alpha, beta, delta points
-        pk.alpha = G * alpha_scalar;
-        pk.beta = G * beta_scalar;
-        pk.delta = G * delta_scalar;
-        
-        std::cout << "\nProving key alpha = " << pk.alpha << std::endl;
-        std::cout << "Proving key beta = " << pk.beta << std::endl;
-        std::cout << "Proving key delta = " << pk.delta << std::endl;
-        
-        // Generate verification key
-        vk.alpha = G * alpha_scalar;
-        vk.beta = G * beta_scalar;
-        vk.gamma = G * gamma_scalar;
-        vk.delta = G * delta_scalar;
+        // H(x) has degree at most N - 2: tau^i Z(tau) / delta for i < N - 1
+        sc.h_size = qap.domain.size() > 1 ? qap.domain.size() - 1 : 1;
+        sc.z_over_delta = qap.domain.evaluateVanishing(sc.tau) / sc.delta;
+        return sc;
+    }
+    
+    static KeyFixedPoints<Pairing> fixedPoints(const SetupScalars& sc) {
+        KeyFixedPoints<Pairing> fixed;
+        fixed.alpha = Pairing::g1() * sc.alpha;
+        fixed.beta = Pairing::g1() * sc.beta;
+        fixed.delta = Pairing::g1() * sc.delta;
+        fixed.beta_g2 = Pairing::g2() * sc.beta;
+        fixed.delta_g2 = Pairing::g2() * sc.delta;
+        return fixed;
+    }
+    
+    static void fillVerificationKey(const SetupScalars& sc, const FixedBaseTable<G1>& G, VerificationKey& vk) {
+        vk.alpha = Pairing::g1() * sc.alpha;
+        vk.beta = Pairing::g2() * sc.beta;
+        vk.gamma = Pairing::g2() * sc.gamma;
+        vk.delta = Pairing::g2() * sc.delta;
         
         std::cout << "\nVerification key generated:" << std::endl;
         std::cout << "  alpha = " << vk.alpha << std::endl;
@@ -109,91 +313,345 @@ public:
         std::cout << "  delta = " << vk.delta << std::endl;
         
         // Generate IC for public inputs
-        std::cout << "\nGenerating IC for " << num_public_inputs << " public inputs..." << std::endl;
-        for (int i = 0; i <= num_public_inputs; i++) {
-            vk.IC.push_back(G * (i + 1)); // Simplified
+        std::cout << "\nGenerating IC for " << sc.public_variables.size() << " public inputs..." << std::endl;
+        vk.IC = G.multiplyBatch(sc.icScalars());
+        for (size_t i = 0; i < vk.IC.size(); i++) {
             std::cout << "  IC[" << i << "] = " << vk.IC[i] << std::endl;
         }
-        
-        std::cout << "\n=== Setup Complete ===" << std::endl;
+    }
+
+    // Progress output of prove(); servers proving many jobs turn it off
+    static std::atomic<bool>& verboseFlag() {
+        static std::atomic<bool> flag(true);
+        return flag;
     }
     
-    // Prove phase: Create a proof
-    static Proof prove(const QAP& qap, 
-                      const ProvingKey& pk,
-                      const std::vector<FieldElement>& witness,
-                      const std::vector<FieldElement>& public_inputs) {
-        std::cout << "\n=== zkSNARK Prove Phase ===" << std::endl;
+    // Key access shared by the in-memory and the mapped proving key, so
+    // that one prover body serves both
+    static const std::vector<G1>& query(const ProvingKey& pk, KeySection section) {
+        switch (section) {
+            case KeySection::A: return pk.A_query;
+            case KeySection::B: return pk.B_query;
+            case KeySection::H: return pk.H_query;
+            case KeySection::L: break;
+        }
+        return pk.L_query;
+    }
+    static QueryView<G1> query(const MappedProvingKey& pk, KeySection section) {
+        return pk.section(section);
+    }
+    static size_t querySize(const ProvingKey& pk, KeySection section) {
+        return query(pk, section).size();
+    }
+    static size_t querySize(const MappedProvingKey& pk, KeySection section) {
+        return static_cast<size_t>(pk.info().sections[static_cast<size_t>(section)].count);
+    }
+    static KeyFixedPoints<Pairing> fixedPoints(const ProvingKey& pk) {
+        KeyFixedPoints<Pairing> fixed;
+        fixed.alpha = pk.alpha;
+        fixed.beta = pk.beta;
+        fixed.delta = pk.delta;
+        fixed.beta_g2 = pk.beta_g2;
+        fixed.delta_g2 = pk.delta_g2;
+        return fixed;
+    }
+    static KeyFixedPoints<Pairing> fixedPoints(const MappedProvingKey& pk) {
+        return pk.fixedPoints();
+    }
+    
+    static const std::vector<size_t>& privateVariables(const ProvingKey& pk) {
+        return pk.private_variables;
+    }
+    static std::vector<size_t> privateVariables(const MappedProvingKey& pk) {
+        return pk.privateVariables();
+    }
+    
+    template <typename Key>
+    static Proof proveWith(const QAP& qap, const Key& pk, const std::vector<FieldElement>& witness) {
+        bool verbose = verboseFlag().load();
+        if (verbose) {
+            std::cout << "\n=== zkSNARK Prove Phase ===" << std::endl;
+            
+            std::cout << "Witness values: [";
+            for (size_t i = 0; i < witness.size(); i++) {
+                std::cout << witness[i];
+                if (i < witness.size() - 1) std::cout << ", ";
+            }
+            std::cout << "]" << std::endl;
+        }
         
-        std::cout << "Witness values: [";
-        for (size_t i = 0; i < witness.size(); i++) {
-            std::cout << witness[i];
-            if (i < witness.size() - 1) std::cout << ", ";
+        ProverJob job;
+        scratchArena().resetHighWaterMark();
+        startProof(qap, pk, witness, job);
+        computeQuotient(qap, pk, job);
+        
+        if (verbose) {
+            std::cout << "\nComputed polynomials from witness:" << std::endl;
+            std::cout << "  A(x) = "; job.A_poly.print(); std::cout << std::endl;
+            std::cout << "  B(x) = "; job.B_poly.print(); std::cout << std::endl;
+            std::cout << "  C(x) = "; job.C_poly.print(); std::cout << std::endl;
+            std::cout << "  H(x) = "; job.H_poly.print(); std::cout << std::endl;
+            
+            std::cout << "\nGenerated random blinding factors:" << std::endl;
+            std::cout << "  r = " << job.r << std::endl;
+            std::cout << "  s = " << job.s << std::endl;
         }
-        std::cout << "]" << std::endl;
         
-        Proof proof;
+        // The four MSMs are independent
+        parallelFor(0, KEY_SECTION_COUNT, 1, [&](size_t lo, size_t hi) {
+            for (size_t k = lo; k < hi; k++) {
+                computeQuerySum(pk, static_cast<KeySection>(k), job);
+            }
+        });
+        Proof proof = finishProof(pk, job);
+        
+        if (verbose) {
+            std::cout << "\nProof.A = " << proof.A << std::endl;
+            std::cout << "Proof.B = " << proof.B << std::endl;
+            std::cout << "Proof.C = " << proof.C << std::endl;
+            
+            scratchArena().printStats("Prover scratch arena");
+            
+            std::cout << "\n=== Proof Generation Complete ===" << std::endl;
+        }
         
-        // Compute A, B, C polynomials with witness
-        Polynomial A_poly, B_poly, C_poly;
-        qap.computePolynomials(witness, A_poly, B_poly, C_poly);
+        return proof;
+    }
+
+public:
+    static void setVerbose(bool verbose) { verboseFlag().store(verbose); }
+    
+    // Setup phase: Generate proving and verification keys. The public
+    // inputs are the variables 1 .. num_public_inputs (variable 0 is the
+    // constant one).
+    static void setup(const QAP& qap, const R1CS& r1cs, 
+                     ProvingKey& pk, VerificationKey& vk, 
+                     int num_public_inputs) {
+        std::vector<size_t> public_variables;
+        for (int i = 1; i <= num_public_inputs; i++) {
+            public_variables.push_back(static_cast<size_t>(i));
+        }
+        setup(qap, r1cs, pk, vk, public_variables);
+    }
+
+    // Setup with the public inputs at the given variable indices, in the
+    // order the verifier will supply them. Runs in two parallel stages:
+    // evaluation of the QAP at tau, then fixed-base multiplication of
+    // every query scalar.
+    static void setup(const QAP& qap, const R1CS& r1cs,
+                     ProvingKey& pk, VerificationKey& vk,
+                     const std::vector<size_t>& public_variables) {
+        (void)r1cs;
+        std::cout << "\n=== zkSNARK Setup Phase ===" << std::endl;
         
-        std::cout << "\nComputed polynomials from witness:" << std::endl;
-        std::cout << "  A(x) = "; A_poly.print(); std::cout << std::endl;
-        std::cout << "  B(x) = "; B_poly.print(); std::cout << std::endl;
-        std::cout << "  C(x) = "; C_poly.print(); std::cout << std::endl;
+        SetupScalars sc = prepareSetup(qap, public_variables);
+        FixedBaseTable<G1> G(Pairing::g1());
+        std::cout << "\nGenerator G = " << Pairing::g1() << std::endl;
         
-        // Generate random blinding factors
-        uint64_t r = randomScalar();
-        uint64_t s = randomScalar();
+        // Generate proving key queries
+        std::cout << "\nGenerating proving key queries..." << std::endl;
+        std::vector<G1>* queries[KEY_SECTION_COUNT] = {
+            &pk.A_query, &pk.B_query, &pk.H_query, &pk.L_query};
+        std::vector<FieldElement> scalars;
+        for (size_t s = 0; s < KEY_SECTION_COUNT; s++) {
+            KeySection section = static_cast<KeySection>(s);
+            scalars.resize(sc.count(section));
+            sc.fill(section, 0, scalars.size(), scalars.data());
+            queries[s]->resize(scalars.size());
+            G.multiplyBatch(scalars.data(), scalars.size(), queries[s]->data());
+        }
+        pk.private_variables = sc.private_variables;
         
-        std::cout << "\nGenerated random blinding factors:" << std::endl;
-        std::cout << "  r = " << r << std::endl;
-        std::cout << "  s = " << s << std::endl;
+        std::cout << "  A, B queries: " << pk.A_query.size() << " elements each" << std::endl;
+        std::cout << "  H query: " << pk.H_query.size() << " elements" << std::endl;
+        std::cout << "  L query: " << pk.L_query.size() << " private variables" << std::endl;
         
-        // Compute proof elements (simplified)
-        ECPoint::setCurveParams(FieldElement(0), FieldElement(7));
-        ECPoint G(FieldElement(2), FieldElement(1234567));
+        // Generate alpha, beta, delta elements
+        KeyFixedPoints<Pairing> fixed = fixedPoints(sc);
+        pk.alpha = fixed.alpha;
+        pk.beta = fixed.beta;
+        pk.beta_g2 = fixed.beta_g2;
+        pk.delta = fixed.delta;
+        pk.delta_g2 = fixed.delta_g2;
         
-        // A = sum of A_query weighted by witness + random
-        proof.A = ECPoint();
-        for (size_t i = 0; i < witness.size(); i++) {
-            if (i < pk.A_query.size()) {
-                proof.A = proof.A + pk.A_query[i] * witness[i].getValue();
-            }
-        }
-        proof.A = proof.A + pk.alpha * r;
+        std::cout << "\nProving key alpha = " << pk.alpha << std::endl;
+        std::cout << "Proving key beta = " << pk.beta << std::endl;
+        std::cout << "Proving key delta = " << pk.delta << std::endl;
         
-        std::cout << "\nProof.A = " << proof.A << std::endl;
+        fillVerificationKey(sc, G, vk);
         
-        // B = sum of B_query weighted by witness + random
-        proof.B = ECPoint();
-        for (size_t i = 0; i < witness.size(); i++) {
-            if (i < pk.B_query.size()) {
-                proof.B = proof.B + pk.B_query[i] * witness[i].getValue();
+        std::cout << "\n=== Setup Complete ===" << std::endl;
+    }
+    
+    // Setup that streams the proving key to `path` in chunks of
+    // `chunk_points` elements instead of building it in memory: besides the
+    // O(n) scalars at tau, memory stays at a few chunks however large the
+    // circuit. Use the key in place with MappedProvingKey, or load it with
+    // loadProvingKey.
+    static void setupToFile(const QAP& qap, const std::vector<size_t>& public_variables,
+                            const std::string& path, VerificationKey& vk,
+                            size_t chunk_points = size_t(1) << 16) {
+        std::cout << "\n=== zkSNARK Setup Phase (streaming to " << path << ") ===" << std::endl;
+        
+        SetupScalars sc = prepareSetup(qap, public_variables);
+        FixedBaseTable<G1> G(Pairing::g1());
+        
+        // A zero scalar gives the identity, which the file leaves out; the
+        // nonzero scalars bound the elements each section stores
+        chunk_points = std::max<size_t>(chunk_points, 1);
+        std::vector<FieldElement> scalars(chunk_points);
+        uint64_t counts[KEY_SECTION_COUNT];
+        uint64_t present[KEY_SECTION_COUNT];
+        for (size_t s = 0; s < KEY_SECTION_COUNT; s++) {
+            KeySection section = static_cast<KeySection>(s);
+            counts[s] = sc.count(section);
+            present[s] = 0;
+            for (size_t begin = 0; begin < counts[s]; begin += chunk_points) {
+                size_t end = std::min<size_t>(begin + chunk_points, counts[s]);
+                sc.fill(section, begin, end, scalars.data());
+                present[s] += static_cast<uint64_t>(end - begin) -
+                    std::count(scalars.begin(), scalars.begin() + (end - begin), FieldElement(0));
             }
         }
-        proof.B = proof.B + pk.beta * s;
-        
-        std::cout << "Proof.B = " << proof.B << std::endl;
-        
-        // C = sum of C_query weighted by witness
-        proof.C = ECPoint();
-        for (size_t i = 0; i < witness.size(); i++) {
-            if (i < pk.C_query.size()) {
-                proof.C = proof.C + pk.C_query[i] * witness[i].getValue();
+        ProvingKeyWriter<Pairing> writer(path, static_cast<uint64_t>(qap.num_variables), counts, present,
+                                         sc.private_variables, fixedPoints(sc));
+        
+        std::vector<G1> points(chunk_points);
+        for (size_t s = 0; s < KEY_SECTION_COUNT; s++) {
+            KeySection section = static_cast<KeySection>(s);
+            for (size_t begin = 0; begin < counts[s]; begin += chunk_points) {
+                size_t end = std::min<size_t>(begin + chunk_points, counts[s]);
+                sc.fill(section, begin, end, scalars.data());
+                G.multiplyBatch(scalars.data(), end - begin, points.data());
+                writer.append(points.data(), end - begin);
             }
         }
-        proof.C = proof.C + pk.delta * (r * s);
+        writer.finish();
+        std::cout << "Proving key written: " << qap.num_variables << " variables, "
+                  << counts[static_cast<size_t>(KeySection::H)] << " H elements" << std::endl;
         
-        std::cout << "Proof.C = " << proof.C << std::endl;
-        
-        std::cout << "\n=== Proof Generation Complete ===" << std::endl;
+        fillVerificationKey(sc, G, vk);
         
+        std::cout << "\n=== Setup Complete ===" << std::endl;
+    }
+    
+    // Read a proving key written by setupToFile into memory, checking the
+    // whole file against its checksum
+    static ProvingKey loadProvingKey(const std::string& path) {
+        MappedProvingKey key(path, true);
+        ProvingKey pk;
+        KeyFixedPoints<Pairing> fixed = key.fixedPoints();
+        pk.alpha = fixed.alpha;
+        pk.beta = fixed.beta;
+        pk.beta_g2 = fixed.beta_g2;
+        pk.delta = fixed.delta;
+        pk.delta_g2 = fixed.delta_g2;
+        pk.A_query = key.section(KeySection::A).toVector();
+        pk.B_query = key.section(KeySection::B).toVector();
+        pk.H_query = key.section(KeySection::H).toVector();
+        pk.L_query = key.section(KeySection::L).toVector();
+        pk.private_variables = key.privateVariables();
+        return pk;
+    }
+    
+    // Proving in stages, for schedulers that overlap them (see
+    // async_prover.h); prove() runs them in order. After startProof, the
+    // A, B and L sums need only the witness, and computeQuotient runs
+    // alongside them; the H sum needs the quotient; finishProof needs all
+    // four sums. Stages of one job touch disjoint fields.
+    
+    // Check the witness and draw the blinding factors
+    template <typename Key>
+    static void startProof(const QAP& qap, const Key& pk, const std::vector<FieldElement>& witness,
+                           ProverJob& job) {
+        // Reject a witness that does not satisfy the QAP before any proving work
+        if (witness.size() < static_cast<size_t>(qap.num_variables)) {
+            throw InvalidWitnessError("Witness is shorter than the number of QAP variables");
+        }
+        if (!qap.checkWitness(witness)) {
+            throw InvalidWitnessError("Witness does not satisfy the QAP");
+        }
+        if (querySize(pk, KeySection::A) != static_cast<size_t>(qap.num_variables)) {
+            throw std::runtime_error("Proving key does not match the QAP");
+        }
+        job.w.assign(witness.begin(), witness.begin() + qap.num_variables);
+        const std::vector<size_t>& private_variables = privateVariables(pk);
+        job.w_private.resize(private_variables.size());
+        for (size_t j = 0; j < private_variables.size(); j++) {
+            job.w_private[j] = witness[private_variables[j]];
+        }
+        job.r = FieldElement(randomScalar());
+        job.s = FieldElement(randomScalar());
+    }
+    
+    // Quotient H(x) = (A(x)·B(x) - C(x)) / Z(x) over the QAP's domain
+    template <typename Key>
+    static void computeQuotient(const QAP& qap, const Key& pk, ProverJob& job) {
+        qap.computePolynomials(job.w, job.A_poly, job.B_poly, job.C_poly);
+        Polynomial remainder;
+        job.H_poly = qap.domain.divideByVanishing(
+            EvaluationDomain::multiply(job.A_poly, job.B_poly) - job.C_poly, remainder);
+        // The division is exact: a zero remainder proves A*B - C = Z*H
+        if (remainder.degree() >= 0) {
+            throw std::runtime_error("A(x)·B(x) - C(x) is not divisible by Z(x)");
+        }
+        if (job.H_poly.degree() >= static_cast<int>(querySize(pk, KeySection::H))) {
+            throw std::runtime_error("Quotient degree exceeds the proving key's H query");
+        }
+        job.h_coeffs = job.H_poly.coefficients;
+        job.h_coeffs.resize(querySize(pk, KeySection::H), FieldElement(0));
+    }
+    
+    // One MSM: the query's elements against the witness (A, B), the
+    // private witness (L) or the quotient (H)
+    template <typename Key>
+    static void computeQuerySum(const Key& pk, KeySection section, ProverJob& job) {
+        const std::vector<FieldElement>& scalars =
+            section == KeySection::L ? job.w_private :
+            section == KeySection::H ? job.h_coeffs : job.w;
+        job.sums[static_cast<size_t>(section)] = msm(query(pk, section), scalars);
+    }
+    
+    template <typename Key>
+    static Proof finishProof(const Key& pk, const ProverJob& job) {
+        auto sum = [&](KeySection section) { return job.sums[static_cast<size_t>(section)]; };
+        KeyFixedPoints<Pairing> fixed = fixedPoints(pk);
+        Proof proof;
+        proof.A = fixed.alpha + sum(KeySection::A) + fixed.delta * job.r;
+        // [B_i(tau)]_2 = [B_i(tau)]_1 with a symmetric backend
+        proof.B = fixed.beta_g2 + sum(KeySection::B) + fixed.delta_g2 * job.s;
+        G1 B_g1 = fixed.beta + sum(KeySection::B) + fixed.delta * job.s;
+        proof.C = sum(KeySection::L) + sum(KeySection::H) + proof.A * job.s + B_g1 * job.r
+                - fixed.delta * (job.r * job.s);
         return proof;
     }
     
-    // Verify phase: Verify a proof
+    // Prove phase: Create a proof
+    //   A = [alpha]_1 + sum_i w_i [A_i(tau)]_1 + r [delta]_1
+    //   B = [beta]_2  + sum_i w_i [B_i(tau)]_2 + s [delta]_2
+    //   C = sum_private w_i L_i + sum_j h_j H_j + s A + r B_1 - r s [delta]_1
+    // where B_1 is B computed in G1. Every sum is one MSM.
+    static Proof prove(const QAP& qap, 
+                      const ProvingKey& pk,
+                      const std::vector<FieldElement>& witness,
+                      const std::vector<FieldElement>& public_inputs) {
+        (void)public_inputs;
+        return proveWith(qap, pk, witness);
+    }
+    
+    // Prove straight from a mapped key file: the MSMs read the key's
+    // element arrays in place
+    static Proof prove(const QAP& qap,
+                      const MappedProvingKey& pk,
+                      const std::vector<FieldElement>& witness,
+                      const std::vector<FieldElement>& public_inputs) {
+        (void)public_inputs;
+        return proveWith(qap, pk, witness);
+    }
+    
+    // Verify phase: check the pairing equation
+    //   e(A, B) = e(alpha, beta) e(vk_x, gamma) e(C, delta)
+    // with vk_x = IC[0] + sum_i input_i IC[i + 1], as one multi-pairing
     static bool verify(const VerificationKey& vk,
                       const Proof& proof,
                       const std::vector<FieldElement>& public_inputs) {
@@ -211,35 +669,31 @@ public:
         std::cout << "  Checking Proof.B = " << proof.B << std::endl;
         std::cout << "  Checking Proof.C = " << proof.C << std::endl;
         
-        // Compute input consistency check
-        ECPoint vk_x = ECPoint();
-        if (!vk.IC.empty()) {
-            vk_x = vk.IC[0];
+        if (vk.IC.size() != public_inputs.size() + 1) {
+            std::cout << "\nExpected " << (vk.IC.empty() ? 0 : vk.IC.size() - 1)
+                      << " public inputs: FAILED" << std::endl;
+            std::cout << "\n=== Verification Complete ===" << std::endl;
+            return false;
         }
         
+        // Compute input consistency check
+        G1 vk_x = vk.IC[0];
         for (size_t i = 0; i < public_inputs.size(); i++) {
-            if (i + 1 < vk.IC.size()) {
-                vk_x = vk_x + vk.IC[i + 1] * public_inputs[i].getValue();
-            }
+            vk_x = vk_x + vk.IC[i + 1] * public_inputs[i];
         }
         
         std::cout << "\nInput consistency check value: " << vk_x << std::endl;
         
-        // Simplified verification: Check that proof components are not at infinity
-        bool valid = !proof.A.isInfinity() && 
-                    !proof.B.isInfinity() && 
-                    !proof.C.isInfinity();
+        bool valid = Pairing::check({{proof.A, proof.B},
+                                     {G1() - vk.alpha, vk.beta},
+                                     {G1() - vk_x, vk.gamma},
+                                     {G1() - proof.C, vk.delta}});
         
-        // In a real implementation, we would check pairing equations:
-        // e(A, B) = e(alpha, beta) * e(vk_x, gamma) * e(C, delta)
-        
-        std::cout << "\nPairing check (simplified): ";
+        std::cout << "\nPairing check e(A, B) = e(alpha, beta) e(vk_x, gamma) e(C, delta): ";
         if (valid) {
             std::cout << "PASSED" << std::endl;
-            std::cout << "✓ Proof components are valid elliptic curve points" << std::endl;
         } else {
             std::cout << "FAILED" << std::endl;
-            std::cout << "✗ Proof contains invalid points" << std::endl;
         }
         
         std::cout << "\n=== Verification Complete ===" << std::endl;
@@ -248,4 +702,12 @@ public:
     }
 };
 
+// The protocol over the toy pairing, as used by the examples
+using ProvingKey = Groth16ProvingKey<ToyPairing>;
+using VerificationKey = Groth16VerificationKey<ToyPairing>;
+using Proof = Groth16Proof<ToyPairing>;
+using ProverJob = Groth16ProverJob<ToyPairing>;
+using PreparedVerificationKey = Groth16PreparedVerificationKey<ToyPairing>;
+using zkSNARK = Groth16<ToyPairing>;
+
 #endif // ZKSNARK_H